@@ -1,4 +1,5 @@
 #include "raylib.h"
+#include "rlgl.h"
 #include <iostream>
 #include <string>
 #include <fstream>
@@ -9,7 +10,263 @@
 #include <iomanip>
 #include <sstream>
 #include <cstring>
+#include <cstdio>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <memory>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+#include <atomic>
+
+// --- Window / GPU / input backend ---
+// Everything main() needs from the window, the GPU and the input devices goes through gBackend.
+// RaylibBackend forwards to raylib; NullBackend (--headless) draws nothing, records the frame's
+// draw commands and takes its input from a script, so the full state machine can be benchmarked
+// on a machine without a GPU. CPU-only raylib helpers (MeasureTextEx, images, Fade, collisions)
+// are called directly.
+struct Backend {
+    virtual ~Backend() {}
+    // Window and frame pacing
+    virtual void InitWindow(int width, int height, const char *title) = 0;
+    virtual void CloseWindow() = 0;
+    virtual bool WindowShouldClose() = 0;
+    virtual bool IsWindowResized() = 0;
+    virtual bool IsWindowFullscreen() = 0;
+    virtual void ToggleFullscreen() = 0;
+    virtual void SetWindowSize(int width, int height) = 0;
+    virtual void SetWindowPosition(int x, int y) = 0;
+    virtual int GetMonitorWidth(int monitor) = 0;
+    virtual int GetMonitorHeight(int monitor) = 0;
+    virtual int GetScreenWidth() = 0;
+    virtual int GetScreenHeight() = 0;
+    virtual void SetTargetFPS(int fps) = 0;
+    virtual void EnableEventWaiting() = 0;
+    virtual void DisableEventWaiting() = 0;
+    virtual double GetTime() = 0;
+    virtual float GetFrameTime() = 0;
+    // Drawing
+    virtual void BeginDrawing() = 0;
+    virtual void EndDrawing() = 0;
+    virtual void ClearBackground(Color color) = 0;
+    virtual void BeginTextureMode(RenderTexture2D target) = 0;
+    virtual void EndTextureMode() = 0;
+    virtual void DrawRectangle(int x, int y, int width, int height, Color color) = 0;
+    virtual void DrawRectangleRec(Rectangle rec, Color color) = 0;
+    virtual void DrawRectangleLinesEx(Rectangle rec, float lineThick, Color color) = 0;
+    virtual void DrawTextureEx(Texture2D texture, Vector2 position, float rotation, float scale, Color tint) = 0;
+    virtual void DrawTextureRec(Texture2D texture, Rectangle source, Vector2 position, Color tint) = 0;
+    virtual void DrawTexturePro(Texture2D texture, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint) = 0;
+    virtual void DrawTextEx(Font font, const char *text, Vector2 position, float fontSize, float spacing, Color tint) = 0;
+    virtual void SetShapesTexture(Texture2D texture, Rectangle source) = 0;
+    virtual Texture2D GetShapesTexture() = 0;
+    virtual Rectangle GetShapesTextureRectangle() = 0;
+    // GPU resources
+    virtual Texture2D LoadTexture(const char *fileName) = 0;
+    virtual Texture2D LoadTextureFromImage(Image image) = 0;
+    virtual void UpdateTexture(Texture2D texture, const void *pixels) = 0;
+    virtual void UpdateTextureRec(Texture2D texture, Rectangle rec, const void *pixels) = 0;
+    virtual void UnloadTexture(Texture2D texture) = 0;
+    virtual void SetTextureFilter(Texture2D texture, int filter) = 0;
+    virtual RenderTexture2D LoadRenderTexture(int width, int height) = 0;
+    virtual void UnloadRenderTexture(RenderTexture2D target) = 0;
+    // Input
+    virtual Vector2 GetMousePosition() = 0;
+    virtual Vector2 GetMouseDelta() = 0;
+    virtual float GetMouseWheelMove() = 0;
+    virtual bool IsMouseButtonPressed(int button) = 0;
+    virtual bool IsMouseButtonReleased(int button) = 0;
+    virtual bool IsMouseButtonDown(int button) = 0;
+    virtual bool IsKeyPressed(int key) = 0;
+    virtual bool IsKeyDown(int key) = 0;
+    virtual bool IsKeyPressedRepeat(int key) = 0;
+    virtual int GetKeyPressed() = 0;
+    virtual int GetCharPressed() = 0;
+    virtual const char *GetClipboardText() = 0;
+    virtual void SetClipboardText(const char *text) = 0;
+};
+
+struct RaylibBackend : Backend {
+    void InitWindow(int width, int height, const char *title) override { ::InitWindow(width, height, title); }
+    void CloseWindow() override { ::CloseWindow(); }
+    bool WindowShouldClose() override { return ::WindowShouldClose(); }
+    bool IsWindowResized() override { return ::IsWindowResized(); }
+    bool IsWindowFullscreen() override { return ::IsWindowFullscreen(); }
+    void ToggleFullscreen() override { ::ToggleFullscreen(); }
+    void SetWindowSize(int width, int height) override { ::SetWindowSize(width, height); }
+    void SetWindowPosition(int x, int y) override { ::SetWindowPosition(x, y); }
+    int GetMonitorWidth(int monitor) override { return ::GetMonitorWidth(monitor); }
+    int GetMonitorHeight(int monitor) override { return ::GetMonitorHeight(monitor); }
+    int GetScreenWidth() override { return ::GetScreenWidth(); }
+    int GetScreenHeight() override { return ::GetScreenHeight(); }
+    void SetTargetFPS(int fps) override { ::SetTargetFPS(fps); }
+    void EnableEventWaiting() override { ::EnableEventWaiting(); }
+    void DisableEventWaiting() override { ::DisableEventWaiting(); }
+    double GetTime() override { return ::GetTime(); }
+    float GetFrameTime() override { return ::GetFrameTime(); }
+    void BeginDrawing() override { ::BeginDrawing(); }
+    void EndDrawing() override { ::EndDrawing(); }
+    void ClearBackground(Color color) override { ::ClearBackground(color); }
+    void BeginTextureMode(RenderTexture2D target) override { ::BeginTextureMode(target); }
+    void EndTextureMode() override { ::EndTextureMode(); }
+    void DrawRectangle(int x, int y, int width, int height, Color color) override { ::DrawRectangle(x, y, width, height, color); }
+    void DrawRectangleRec(Rectangle rec, Color color) override { ::DrawRectangleRec(rec, color); }
+    void DrawRectangleLinesEx(Rectangle rec, float lineThick, Color color) override { ::DrawRectangleLinesEx(rec, lineThick, color); }
+    void DrawTextureEx(Texture2D texture, Vector2 position, float rotation, float scale, Color tint) override { ::DrawTextureEx(texture, position, rotation, scale, tint); }
+    void DrawTextureRec(Texture2D texture, Rectangle source, Vector2 position, Color tint) override { ::DrawTextureRec(texture, source, position, tint); }
+    void DrawTexturePro(Texture2D texture, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint) override { ::DrawTexturePro(texture, source, dest, origin, rotation, tint); }
+    void DrawTextEx(Font font, const char *text, Vector2 position, float fontSize, float spacing, Color tint) override { ::DrawTextEx(font, text, position, fontSize, spacing, tint); }
+    void SetShapesTexture(Texture2D texture, Rectangle source) override { ::SetShapesTexture(texture, source); }
+    Texture2D GetShapesTexture() override { return ::GetShapesTexture(); }
+    Rectangle GetShapesTextureRectangle() override { return ::GetShapesTextureRectangle(); }
+    Texture2D LoadTexture(const char *fileName) override { return ::LoadTexture(fileName); }
+    Texture2D LoadTextureFromImage(Image image) override { return ::LoadTextureFromImage(image); }
+    void UpdateTexture(Texture2D texture, const void *pixels) override { ::UpdateTexture(texture, pixels); }
+    void UpdateTextureRec(Texture2D texture, Rectangle rec, const void *pixels) override { ::UpdateTextureRec(texture, rec, pixels); }
+    void UnloadTexture(Texture2D texture) override { ::UnloadTexture(texture); }
+    void SetTextureFilter(Texture2D texture, int filter) override { ::SetTextureFilter(texture, filter); }
+    RenderTexture2D LoadRenderTexture(int width, int height) override { return ::LoadRenderTexture(width, height); }
+    void UnloadRenderTexture(RenderTexture2D target) override { ::UnloadRenderTexture(target); }
+    Vector2 GetMousePosition() override { return ::GetMousePosition(); }
+    Vector2 GetMouseDelta() override { return ::GetMouseDelta(); }
+    float GetMouseWheelMove() override { return ::GetMouseWheelMove(); }
+    bool IsMouseButtonPressed(int button) override { return ::IsMouseButtonPressed(button); }
+    bool IsMouseButtonReleased(int button) override { return ::IsMouseButtonReleased(button); }
+    bool IsMouseButtonDown(int button) override { return ::IsMouseButtonDown(button); }
+    bool IsKeyPressed(int key) override { return ::IsKeyPressed(key); }
+    bool IsKeyDown(int key) override { return ::IsKeyDown(key); }
+    int GetKeyPressed() override { return ::GetKeyPressed(); }
+    bool IsKeyPressedRepeat(int key) override { return ::IsKeyPressedRepeat(key); }
+    int GetCharPressed() override { return ::GetCharPressed(); }
+    const char *GetClipboardText() override { return ::GetClipboardText(); }
+    void SetClipboardText(const char *text) override { ::SetClipboardText(text); }
+};
+
+struct NullBackend : Backend {
+    // Draw commands of the current frame (cleared by BeginDrawing)
+    enum CommandType { CMD_CLEAR, CMD_RECT, CMD_RECT_LINES, CMD_TEXTURE, CMD_TEXT, CMD_TYPE_COUNT };
+    struct Command { CommandType type; Rectangle rect; unsigned int textureId; int glyphs; };
+    std::vector<Command> commands;
+    unsigned long totalCommands[CMD_TYPE_COUNT] = {};
+    unsigned long totalGlyphs = 0;
+    unsigned long totalBinds = 0; // texture changes between consecutive draw commands
+    unsigned int lastTextureId = 0;
+
+    int width = 1280, height = 720;
+    bool resized = false;
+    bool fullscreen = false;
+    bool quit = false; // set by the script runner when the script is done
+    float frameTime = 1.0f / 60.0f;
+    unsigned int nextTextureId = 1;
+    Texture2D shapesTexture = {};
+    Rectangle shapesRec = {};
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Scripted input; the *Pressed/*Released sets only last one frame (see BeginInputFrame)
+    Vector2 mouse = {}, mouseDelta = {};
+    float wheel = 0.0f;
+    bool buttonDown[3] = {}, buttonPressed[3] = {}, buttonReleased[3] = {};
+    std::unordered_set<int> keysDown, keysPressed;
+    std::deque<int> keyQueue, charQueue;
+    std::string clipboard;
+
+    void BeginInputFrame() {
+        for (int b = 0; b < 3; ++b) buttonPressed[b] = buttonReleased[b] = false;
+        keysPressed.clear();
+        keyQueue.clear();
+        mouseDelta = Vector2{ 0, 0 };
+        resized = false;
+    }
+    void Record(CommandType type, Rectangle rect, unsigned int textureId = 0, int glyphs = 0) {
+        commands.push_back(Command{ type, rect, textureId, glyphs });
+        if (type != CMD_CLEAR && textureId != lastTextureId) { totalBinds++; lastTextureId = textureId; }
+        totalCommands[type]++;
+        totalGlyphs += (unsigned long)glyphs;
+    }
+    Texture2D FakeTexture(int w, int h) { Texture2D t = {}; t.id = nextTextureId++; t.width = w; t.height = h; t.mipmaps = 1; return t; }
+
+    void InitWindow(int, int, const char *) override {}
+    void CloseWindow() override {}
+    bool WindowShouldClose() override { return quit; }
+    bool IsWindowResized() override { return resized; }
+    bool IsWindowFullscreen() override { return fullscreen; }
+    void ToggleFullscreen() override { fullscreen = !fullscreen; }
+    void SetWindowSize(int w, int h) override { if (w != width || h != height) { width = w; height = h; resized = true; } }
+    void SetWindowPosition(int, int) override {}
+    int GetMonitorWidth(int) override { return width; }
+    int GetMonitorHeight(int) override { return height; }
+    int GetScreenWidth() override { return width; }
+    int GetScreenHeight() override { return height; }
+    void SetTargetFPS(int) override {}
+    void EnableEventWaiting() override {}
+    void DisableEventWaiting() override {}
+    double GetTime() override { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+    float GetFrameTime() override { return frameTime; }
+    void BeginDrawing() override { commands.clear(); }
+    void EndDrawing() override {}
+    void ClearBackground(Color) override { Record(CMD_CLEAR, Rectangle{ 0, 0, (float)width, (float)height }); }
+    void BeginTextureMode(RenderTexture2D) override {}
+    void EndTextureMode() override {}
+    // Shapes sample the shapes texture, so they count against it for binds
+    void DrawRectangle(int x, int y, int w, int h, Color) override { Record(CMD_RECT, Rectangle{ (float)x, (float)y, (float)w, (float)h }, shapesTexture.id); }
+    void DrawRectangleRec(Rectangle rec, Color) override { Record(CMD_RECT, rec, shapesTexture.id); }
+    void DrawRectangleLinesEx(Rectangle rec, float, Color) override { Record(CMD_RECT_LINES, rec, shapesTexture.id); }
+    void DrawTextureEx(Texture2D texture, Vector2 position, float, float scale, Color) override {
+        Record(CMD_TEXTURE, Rectangle{ position.x, position.y, texture.width * scale, texture.height * scale }, texture.id);
+    }
+    void DrawTextureRec(Texture2D texture, Rectangle source, Vector2 position, Color) override {
+        Record(CMD_TEXTURE, Rectangle{ position.x, position.y, fabsf(source.width), fabsf(source.height) }, texture.id);
+    }
+    void DrawTexturePro(Texture2D texture, Rectangle, Rectangle dest, Vector2, float, Color) override { Record(CMD_TEXTURE, dest, texture.id); }
+    void DrawTextEx(Font font, const char *text, Vector2 position, float fontSize, float, Color) override {
+        Record(CMD_TEXT, Rectangle{ position.x, position.y, 0, fontSize }, font.texture.id, (int)strlen(text));
+    }
+    void SetShapesTexture(Texture2D texture, Rectangle source) override { shapesTexture = texture; shapesRec = source; }
+    Texture2D GetShapesTexture() override { return shapesTexture; }
+    Rectangle GetShapesTextureRectangle() override { return shapesRec; }
+    Texture2D LoadTexture(const char *fileName) override {
+        // Only the size is needed for layout
+        Image image = LoadImage(fileName);
+        Texture2D t = FakeTexture(image.width, image.height);
+        UnloadImage(image);
+        return t;
+    }
+    Texture2D LoadTextureFromImage(Image image) override { return FakeTexture(image.width, image.height); }
+    void UpdateTexture(Texture2D, const void *) override {}
+    void UpdateTextureRec(Texture2D, Rectangle, const void *) override {}
+    void UnloadTexture(Texture2D) override {}
+    void SetTextureFilter(Texture2D, int) override {}
+    RenderTexture2D LoadRenderTexture(int w, int h) override {
+        RenderTexture2D target = {};
+        target.id = nextTextureId++;
+        target.texture = FakeTexture(w, h);
+        return target;
+    }
+    void UnloadRenderTexture(RenderTexture2D) override {}
+    Vector2 GetMousePosition() override { return mouse; }
+    Vector2 GetMouseDelta() override { return mouseDelta; }
+    float GetMouseWheelMove() override { return wheel; }
+    bool IsMouseButtonPressed(int button) override { return button >= 0 && button < 3 && buttonPressed[button]; }
+    bool IsMouseButtonReleased(int button) override { return button >= 0 && button < 3 && buttonReleased[button]; }
+    bool IsMouseButtonDown(int button) override { return button >= 0 && button < 3 && buttonDown[button]; }
+    bool IsKeyPressed(int key) override { return keysPressed.count(key) > 0; }
+    bool IsKeyDown(int key) override { return keysDown.count(key) > 0; }
+    int GetKeyPressed() override { if (keyQueue.empty()) return 0; int k = keyQueue.front(); keyQueue.pop_front(); return k; }
+    bool IsKeyPressedRepeat(int) override { return false; }
+    int GetCharPressed() override { if (charQueue.empty()) return 0; int c = charQueue.front(); charQueue.pop_front(); return c; }
+    const char *GetClipboardText() override { return clipboard.c_str(); }
+    void SetClipboardText(const char *text) override { clipboard = text ? text : ""; }
+};
+
+RaylibBackend gRaylibBackend;
+Backend *gBackend = &gRaylibBackend;
 
 enum AppState { STATE_LOGIN, STATE_REGISTER,STATE_FORGOTPASSWORD, STATE_MENU, STATE_VIEW_TYPE, STATE_CATALOG, STATE_SUB_CATALOG, STATE_VIEW_PRODUCTS, STATE_CART, STATE_ADD_PRODUCT, STATE_EDIT_PRODUCTS, STATE_EDIT_PRODUCT, STATE_USER_MANAGEMENT, STATE_OPTIONS, STATE_EXIT };
 
@@ -101,72 +358,1996 @@ bool CheckLogin(const std::vector<User>& users, const std::string& username, con
     return false;
 }
 
-// Global font used by scaled helpers
-Font gFont = { 0 };
+// Case-insensitive name order over the users vector, so Manage Accounts can page through and
+// prefix-search very large account lists without walking them. order[k] indexes users.
+struct UserNameIndex {
+    std::vector<int> order;
+    unsigned builtVersion = ~0u; // usersVersion the order was built from
+    unsigned revision = 0;       // bumped whenever order changes (rebuild or erase)
+
+    // Compares the first query.size() chars of name with lowerQuery, ignoring case;
+    // 0 means name starts with the query
+    static int ComparePrefix(const std::string &name, const std::string &lowerQuery) {
+        size_t n = std::min(name.size(), lowerQuery.size());
+        for (size_t k = 0; k < n; ++k) {
+            unsigned char a = (unsigned char)std::tolower((unsigned char)name[k]), b = (unsigned char)lowerQuery[k];
+            if (a != b) return a < b ? -1 : 1;
+        }
+        return name.size() < lowerQuery.size() ? -1 : 0;
+    }
+
+    void Build(const std::vector<User> &users, unsigned version) {
+        // Sort contiguous lowercase copies rather than chasing users[] from the comparator
+        std::vector<std::pair<std::string, int>> keys(users.size());
+        for (size_t i = 0; i < users.size(); ++i) {
+            keys[i].first = users[i].name;
+            for (char &c : keys[i].first) c = (char)std::tolower((unsigned char)c);
+            keys[i].second = (int)i;
+        }
+        std::sort(keys.begin(), keys.end(), [&](const std::pair<std::string, int> &a, const std::pair<std::string, int> &b) {
+            if (a.first != b.first) return a.first < b.first;
+            return users[a.second].name < users[b.second].name;
+        });
+        order.resize(keys.size());
+        for (size_t k = 0; k < keys.size(); ++k) order[k] = keys[k].second;
+        builtVersion = version;
+        ++revision;
+    }
+
+    // [first, last) positions in order whose names start with lowerQuery
+    std::pair<size_t, size_t> Range(const std::vector<User> &users, const std::string &lowerQuery) const {
+        auto lo = std::partition_point(order.begin(), order.end(), [&](int i) { return ComparePrefix(users[i].name, lowerQuery) < 0; });
+        auto hi = std::partition_point(lo, order.end(), [&](int i) { return ComparePrefix(users[i].name, lowerQuery) == 0; });
+        return { (size_t)(lo - order.begin()), (size_t)(hi - order.begin()) };
+    }
+
+    // Keeps the order valid when users[userIndex] is erased, without re-sorting
+    void Erase(int userIndex) {
+        order.erase(std::remove(order.begin(), order.end(), userIndex), order.end());
+        for (int &i : order) if (i > userIndex) --i;
+        ++revision;
+    }
+};
+
+// Product model: one catalog line as parsed
+struct Product {
+    std::string name; double price; bool hasPrice; double salePercent; bool hasSale;
+    std::string size; std::string fabric; std::string sex; std::string description; int fileIndex;
+};
+
+// In-memory catalog product: only the fixed-width columns filtering and sorting read. Names,
+// sizes and the text columns stay in the catalog file (see CatalogPages), so every product
+// costs the same few bytes however long its text is. nameRank/sizeOrd are dense ordinals
+// filled in once per catalog load so sorting never needs to compare strings; catMask/groupMask
+// are the category/group membership bits (see CategoryMask/GroupMask).
+struct CatalogEntry {
+    double price = 0.0; double salePercent = 0.0; int fileIndex = 0;
+    uint32_t nameRank = 0; uint32_t sizeOrd = 0;
+    unsigned catMask = 0; unsigned groupMask = 0;
+    bool hasPrice = false; bool hasSale = false; bool hasSize = false;
+};
+
+static inline double EffectivePrice(const Product &p) {
+    return p.hasSale ? p.price * (1.0 - p.salePercent/100.0) : p.price;
+}
+static inline double EffectivePrice(const CatalogEntry &p) {
+    return p.hasSale ? p.price * (1.0 - p.salePercent/100.0) : p.price;
+}
+
+// Parses one catalog line (see LoadProducts for the accepted formats)
+static Product ParseProductLine(const std::string &line, int lineIndex) {
+    // Split by ';' into tokens: name;price;size;description (description optional, may contain semicolons)
+    std::vector<std::string> tokens;
+    size_t start = 0;
+    while (true) {
+        size_t p = line.find(';', start);
+        if (p == std::string::npos) {
+            tokens.push_back(line.substr(start));
+            break;
+        }
+        tokens.push_back(line.substr(start, p - start));
+        start = p + 1;
+    }
+    std::string name = tokens.size() > 0 ? tokens[0] : std::string();
+    std::string priceStr = tokens.size() > 1 ? tokens[1] : std::string();
+    std::string sizeStr = tokens.size() > 2 ? tokens[2] : std::string();
+    std::string fabricStr;
+    std::string sexStr;
+    std::string descStr;
+    double salePercent = 0.0;
+    bool hasSale = false;
+    // Support both old and new formats. Preferred new format:
+    // name;price;size;fabric;sex;description (description may contain ';')
+    if (tokens.size() >= 7) {
+        fabricStr = tokens[3];
+        sexStr = tokens[4];
+        std::string saleStr = tokens[5];
+        descStr = tokens[6];
+        for (size_t i = 7; i < tokens.size(); ++i) descStr += ";" + tokens[i];
+        try { salePercent = std::stod(saleStr); hasSale = true; } catch(...) { hasSale = false; salePercent = 0.0; }
+    } else if (tokens.size() == 6) {
+        // ambiguous: token[5] might be sale or description. Detect numeric -> sale, otherwise description
+        fabricStr = tokens[3];
+        sexStr = tokens[4];
+        std::string t5 = tokens[5];
+        bool looksNumeric = !t5.empty();
+        for (char c : t5) if (!(isdigit((unsigned char)c) || c=='.' || c=='-' )) { looksNumeric = false; break; }
+        if (looksNumeric) {
+            try { salePercent = std::stod(t5); hasSale = true; } catch(...) { hasSale = false; salePercent = 0.0; }
+            descStr.clear();
+        } else {
+            descStr = t5;
+        }
+    } else if (tokens.size() == 5) {
+        // name;price;size;fabric;description  (no sex provided)
+        fabricStr = tokens[3];
+        descStr = tokens[4];
+    } else if (tokens.size() == 4) {
+        // older format: name;price;size;description
+        descStr = tokens[3];
+    }
+
+    double price = 0.0;
+    bool ok = false;
+    if (!priceStr.empty()) {
+        try {
+            size_t s = 0;
+            while (s < priceStr.size() && !((priceStr[s] >= '0' && priceStr[s] <= '9') || priceStr[s] == '.' || priceStr[s] == '-')) s++;
+            std::string trimmed = priceStr.substr(s);
+            price = std::stod(trimmed);
+            ok = true;
+        } catch (...) { ok = false; }
+    }
+    return Product{ name, price, ok, salePercent, hasSale, sizeStr, fabricStr, sexStr, descStr, lineIndex };
+}
+
+// --- Size taxonomy ---
+// Ordered list of known sizes (baby ages, kids ages, letter sizes, numeric/shoe sizes, one-size),
+// compiled into a perfect-hash table so a size string maps to its rank with a single probe.
+// Format (data/sizes.txt or the built-in default): comma-separated sizes in natural order,
+// '|' separates aliases of the same size, "a..b" expands to the integer sizes a to b.
+static const char *kDefaultSizeTaxonomy =
+    "0-3M, 3-6M, 6-9M, 9-12M, 12-18M, 18-24M\n"
+    "2Y, 3Y, 4Y, 5Y, 6Y, 7Y, 8Y, 9Y, 10Y, 11Y, 12Y, 13Y, 14Y, 16Y\n"
+    "XXS, XS, S, M, L, XL, XXL|2XL, XXXL|3XL, 4XL\n"
+    "16..50\n"
+    "OneSize|One Size|OS|U\n";
+
+struct SizeTaxonomy {
+    std::vector<std::string> labels;                    // canonical label per rank
+    std::vector<std::pair<std::string, int>> keys;      // normalized key -> rank (aliases included)
+    std::vector<int> slots;                             // perfect-hash table: index into keys, -1 = empty
+    uint32_t seed = 0;
+    uint32_t mask = 0;
+
+    static std::string Normalize(const std::string &s) {
+        std::string t;
+        for (char c : s) if (c != ' ' && c != '\t' && c != '\r') t.push_back((char)tolower((unsigned char)c));
+        return t;
+    }
+    static uint32_t Hash(const std::string &key, uint32_t seed) {
+        uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+        for (char c : key) { h ^= (unsigned char)c; h *= 16777619u; }
+        return h ^ (h >> 15);
+    }
+
+    void Parse(const std::string &text) {
+        labels.clear(); keys.clear();
+        std::istringstream lines(text);
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream items(line);
+            std::string item;
+            while (std::getline(items, item, ',')) {
+                size_t a = item.find_first_not_of(" \t\r"), b = item.find_last_not_of(" \t\r");
+                if (a == std::string::npos) continue;
+                item = item.substr(a, b - a + 1);
+                size_t dots = item.find("..");
+                if (dots != std::string::npos) {
+                    int lo = atoi(item.substr(0, dots).c_str()), hi = atoi(item.substr(dots + 2).c_str());
+                    for (int v = lo; v <= hi; ++v) Add({ std::to_string(v) });
+                    continue;
+                }
+                std::vector<std::string> aliases;
+                std::istringstream parts(item);
+                std::string alias;
+                while (std::getline(parts, alias, '|')) {
+                    size_t x = alias.find_first_not_of(" \t"), y = alias.find_last_not_of(" \t");
+                    if (x != std::string::npos) aliases.push_back(alias.substr(x, y - x + 1));
+                }
+                if (!aliases.empty()) Add(aliases);
+            }
+        }
+        Compile();
+    }
+
+    void Add(const std::vector<std::string> &aliases) {
+        int rank = (int)labels.size();
+        labels.push_back(aliases[0]);
+        for (const auto &a : aliases) {
+            std::string k = Normalize(a);
+            bool dup = false;
+            for (const auto &e : keys) if (e.first == k) { dup = true; break; }
+            if (!dup && !k.empty()) keys.push_back({k, rank});
+        }
+    }
+
+    // Search for a hash seed that puts every key in its own slot (load factor <= 1/4,
+    // doubling the table if no seed is found quickly)
+    void Compile() {
+        size_t size = 1;
+        while (size < keys.size() * 4) size <<= 1;
+        for (;; size <<= 1) {
+            slots.assign(size, -1);
+            mask = (uint32_t)(size - 1);
+            for (seed = 1; seed <= 4096; ++seed) {
+                std::fill(slots.begin(), slots.end(), -1);
+                bool ok = true;
+                for (size_t k = 0; k < keys.size() && ok; ++k) {
+                    uint32_t slot = Hash(keys[k].first, seed) & mask;
+                    if (slots[slot] >= 0) ok = false;
+                    else slots[slot] = (int)k;
+                }
+                if (ok) return;
+            }
+        }
+    }
+
+    // Rank of a size string, or -1 if it is not in the taxonomy
+    int Rank(const std::string &size) const {
+        if (slots.empty()) return -1;
+        std::string k = Normalize(size);
+        int e = slots[Hash(k, seed) & mask];
+        return (e >= 0 && keys[e].first == k) ? keys[e].second : -1;
+    }
+};
+
+// Natural order for sizes outside the taxonomy: numbers compare by value, with a '.' between digit
+// runs read as a decimal point ("9.25" < "9.5" < "10"). Spellings that compare equal ("09" and "9")
+// fall back to the raw strings so the order stays strict.
+static int CompareNumberAt(const std::string &a, size_t &i, const std::string &b, size_t &j) {
+    auto digitsEnd = [](const std::string &s, size_t k) { while (k < s.size() && isdigit((unsigned char)s[k])) ++k; return k; };
+    // Integer parts: skip leading zeros, then longer is larger, then digit by digit
+    size_t ia = i, ib = j;
+    size_t ea = digitsEnd(a, ia), eb = digitsEnd(b, ib);
+    while (ia + 1 < ea && a[ia] == '0') ++ia;
+    while (ib + 1 < eb && b[ib] == '0') ++ib;
+    if (ea - ia != eb - ib) return ea - ia < eb - ib ? -1 : 1;
+    int c = a.compare(ia, ea - ia, b, ib, eb - ib);
+    if (c != 0) return c < 0 ? -1 : 1;
+    // Fractions: digit by digit, a missing digit counts as '0'
+    size_t fa = ea, fb = eb, za = ea, zb = eb;
+    if (ea + 1 < a.size() && a[ea] == '.' && isdigit((unsigned char)a[ea + 1])) { fa = ea + 1; za = digitsEnd(a, fa); }
+    if (eb + 1 < b.size() && b[eb] == '.' && isdigit((unsigned char)b[eb + 1])) { fb = eb + 1; zb = digitsEnd(b, fb); }
+    for (size_t k = 0; k < std::max(za - fa, zb - fb); ++k) {
+        char da = fa + k < za ? a[fa + k] : '0', db = fb + k < zb ? b[fb + k] : '0';
+        if (da != db) return da < db ? -1 : 1;
+    }
+    i = za; j = zb;
+    return 0;
+}
+
+static bool NaturalLess(const std::string &a, const std::string &b) {
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (isdigit((unsigned char)a[i]) && isdigit((unsigned char)b[j])) {
+            int c = CompareNumberAt(a, i, b, j);
+            if (c != 0) return c < 0;
+        } else {
+            char ca = (char)tolower((unsigned char)a[i]), cb = (char)tolower((unsigned char)b[j]);
+            if (ca != cb) return ca < cb;
+            ++i; ++j;
+        }
+    }
+    if (a.size() - i != b.size() - j) return (a.size() - i) < (b.size() - j);
+    return a < b;
+}
+
+// Category membership bits, indexed like selectedCategory (1=Kid, 2=Man, 3=Women, 4=Baby).
+// Prefers the explicit single-letter code in p.sex (K/M/W/B), falls back to keywords.
+static unsigned CategoryMask(const Product &p) {
+    std::string sexLower = p.sex, lname = p.name, ldesc = p.description;
+    std::transform(sexLower.begin(), sexLower.end(), sexLower.begin(), ::tolower);
+    std::transform(lname.begin(), lname.end(), lname.begin(), ::tolower);
+    std::transform(ldesc.begin(), ldesc.end(), ldesc.begin(), ::tolower);
+    auto has = [&](const char *k) { return lname.find(k) != std::string::npos || ldesc.find(k) != std::string::npos; };
+    unsigned mask = 0;
+    if (sexLower == "k" || has("kid") || has("crian")) mask |= 1u << 1;
+    if (sexLower == "m" || has("men")) mask |= 1u << 2;
+    if (sexLower == "w" || has("women") || has("mulher")) mask |= 1u << 3;
+    if (sexLower == "b" || has("bebe") || has("baby")) mask |= 1u << 4;
+    return mask;
+}
+
+// Product-group membership bits, indexed like selectedProductGroup (2=Accessories, 3=Shoes).
+// Clothes (1) is not a keyword group: it lists everything.
+static unsigned GroupMask(const Product &p) {
+    std::string lname = p.name, ldesc = p.description;
+    std::transform(lname.begin(), lname.end(), lname.begin(), ::tolower);
+    std::transform(ldesc.begin(), ldesc.end(), ldesc.begin(), ::tolower);
+    auto has = [&](const char *k) { return lname.find(k) != std::string::npos || ldesc.find(k) != std::string::npos; };
+    unsigned mask = 0;
+    const char* aks[] = {"accessor", "belt", "hat", "cap", "scarf", "bag", "purse", "sunglass", "earring", "necklace", "watch", "glove", "gloves"};
+    for (const char* k : aks) if (has(k)) { mask |= 1u << 2; break; }
+    const char* sks[] = {"shoe", "sneaker", "boot", "sandals", "trainer", "loafer", "flip", "cleat"};
+    for (const char* k : sks) if (has(k)) { mask |= 1u << 3; break; }
+    return mask;
+}
+
+static inline bool CategoryMatches(unsigned mask, int category) { return category == 0 || (mask & (1u << category)) != 0; }
+static inline bool GroupMatches(unsigned mask, int group) { return group < 2 || (mask & (1u << group)) != 0; }
+
+// Fixed-size bitmap over product indices (one bit per product)
+struct Bitmap {
+    std::vector<uint64_t> words;
+    void Reset(size_t n) { words.assign((n + 63) / 64, 0); }
+    void Set(size_t i) { words[i >> 6] |= 1ull << (i & 63); }
+    bool Test(size_t i) const { return ((words[i >> 6] >> (i & 63)) & 1ull) != 0; }
+};
+
+// Minimal fixed-size worker pool for the large-catalog filter/sort path.
+// ParallelFor runs fn(0..count-1) on the workers and blocks until all calls returned.
+struct ThreadPool {
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mtx;
+    std::condition_variable jobReady;
+    std::condition_variable jobsDone;
+    size_t pending = 0;
+    bool stopping = false;
+
+    explicit ThreadPool(unsigned count) {
+        for (unsigned i = 0; i < count; ++i) workers.emplace_back([this]() { Run(); });
+    }
+    ~ThreadPool() {
+        { std::lock_guard<std::mutex> lock(mtx); stopping = true; }
+        jobReady.notify_all();
+        for (auto &w : workers) w.join();
+    }
+    size_t Size() const { return workers.size(); }
+
+    void Run() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                jobReady.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                if (stopping && jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (--pending == 0) jobsDone.notify_all();
+            }
+        }
+    }
+
+    void ParallelFor(size_t count, const std::function<void(size_t)> &fn) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (size_t i = 0; i < count; ++i) jobs.push_back([&fn, i]() { fn(i); });
+            pending += count;
+        }
+        jobReady.notify_all();
+        std::unique_lock<std::mutex> lock(mtx);
+        jobsDone.wait(lock, [this]() { return pending == 0; });
+    }
+
+    // Queues one job without waiting for it. Don't mix with ParallelFor on the same pool:
+    // ParallelFor would also wait for these.
+    void Submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            jobs.push_back(std::move(job));
+            ++pending;
+        }
+        jobReady.notify_one();
+    }
+};
+
+// Catalogs (or price-range slices) at least this big are filtered and sorted on the thread pool.
+// Override with the PEPKA_PARALLEL_THRESHOLD environment variable (0 disables the parallel path).
+static size_t ParallelFilterThreshold() {
+    static size_t threshold = []() -> size_t {
+        const char *env = getenv("PEPKA_PARALLEL_THRESHOLD");
+        if (env && *env) { long long v = atoll(env); return v <= 0 ? (size_t)-1 : (size_t)v; }
+        return 200000;
+    }();
+    return threshold;
+}
+
+// Price buckets used by the facet counts (effective price); bucket 4 = no price
+static const char *kPriceBucketLabels[] = { "<20", "20-50", "50-100", "100+", "n/a" };
+static inline int PriceBucket(const CatalogEntry &p) {
+    if (!p.hasPrice) return 4;
+    double pr = EffectivePrice(p);
+    if (pr < 20.0) return 0;
+    if (pr < 50.0) return 1;
+    if (pr < 100.0) return 2;
+    return 3;
+}
+
+// Live facet counts for the current search, refreshed together with the filtered list.
+//  category[c]: results if category c were picked (within the current product group), [0] = all
+//  group[g]:    results if product group g were picked (groups ignore category)
+//  size/price:  breakdown of the current result list
+struct FacetCounts {
+    int category[5] = {0};
+    int group[4] = {0};
+    std::vector<int> size; // indexed by Product::sizeOrd
+    int noSize = 0;
+    int price[5] = {0};
+
+    void Add(const FacetCounts &o) {
+        for (int i = 0; i < 5; ++i) { category[i] += o.category[i]; price[i] += o.price[i]; }
+        for (int i = 0; i < 4; ++i) group[i] += o.group[i];
+        for (size_t i = 0; i < size.size() && i < o.size.size(); ++i) size[i] += o.size[i];
+        noSize += o.noSize;
+    }
+};
+
+// LRU cache of filtered+sorted views, keyed by the full filter state (see QueryKey in main).
+// Bounded both by entry count and by the total number of cached indices.
+struct QueryCache {
+    struct Entry { std::string key; std::vector<int> indices; FacetCounts facets; };
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> lookup;
+    size_t maxEntries = 16;
+    size_t maxIndices = 8000000;
+    size_t totalIndices = 0;
+
+    const Entry *Get(const std::string &key) {
+        auto it = lookup.find(key);
+        if (it == lookup.end()) return nullptr;
+        entries.splice(entries.begin(), entries, it->second);
+        return &entries.front();
+    }
+    void Put(const std::string &key, const std::vector<int> &indices, const FacetCounts &facets) {
+        if (indices.size() > maxIndices) return;
+        auto it = lookup.find(key);
+        if (it != lookup.end()) { totalIndices -= it->second->indices.size(); entries.erase(it->second); lookup.erase(it); }
+        entries.push_front({key, indices, facets});
+        lookup[key] = entries.begin();
+        totalIndices += indices.size();
+        while (!entries.empty() && (entries.size() > maxEntries || totalIndices > maxIndices)) {
+            totalIndices -= entries.back().indices.size();
+            lookup.erase(entries.back().key);
+            entries.pop_back();
+        }
+    }
+    void Clear() { entries.clear(); lookup.clear(); totalIndices = 0; }
+};
+
+// --- Sort chains ---
+// A chain is an ordered list of keys (e.g. price -> size -> name). Each product gets the whole
+// chain packed into one 64-bit integer, so sorting is a plain integer sort.
+enum SortField { SORT_LIST_PRICE, SORT_PRICE, SORT_SIZE, SORT_DISCOUNT, SORT_NAME };
+struct SortKeyPart { SortField field; bool descending; };
+struct SortChain { std::string label; std::vector<SortKeyPart> parts; };
+
+// Built-in chains. Indices 0..4 are the classic sortMode values (default, price ^/v, size ^/v);
+// the rest are the extra chains offered by the "Sort" toolbar button.
+static std::vector<SortChain> DefaultSortChains() {
+    return {
+        { "Default", { {SORT_LIST_PRICE, false}, {SORT_NAME, false} } },
+        { "Price ^", { {SORT_PRICE, false}, {SORT_NAME, false} } },
+        { "Price v", { {SORT_PRICE, true}, {SORT_NAME, false} } },
+        { "Size ^",  { {SORT_SIZE, false}, {SORT_NAME, false} } },
+        { "Size v",  { {SORT_SIZE, true}, {SORT_NAME, false} } },
+        { "Price>Size>Name", { {SORT_PRICE, false}, {SORT_SIZE, false}, {SORT_NAME, false} } },
+        { "Discount>Price",  { {SORT_DISCOUNT, true}, {SORT_PRICE, false}, {SORT_NAME, false} } },
+        { "Size>Price>Name", { {SORT_SIZE, false}, {SORT_PRICE, false}, {SORT_NAME, false} } },
+    };
+}
+
+// Extra chains can be configured in a text file, one chain per line, e.g.
+//   price > size > name
+//   -discount > price
+// A leading '-' sorts that key descending. Valid keys: price, list, size, discount, name.
+static void LoadSortChains(const std::string &filename, std::vector<SortChain> &chains) {
+    std::ifstream file(filename);
+    if (!file.is_open()) return;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        SortChain chain;
+        std::string label;
+        size_t start = 0;
+        while (start <= line.size()) {
+            size_t p = line.find('>', start);
+            std::string tok = line.substr(start, p == std::string::npos ? std::string::npos : p - start);
+            size_t a = tok.find_first_not_of(" \t"), b = tok.find_last_not_of(" \t");
+            tok = (a == std::string::npos) ? std::string() : tok.substr(a, b - a + 1);
+            bool desc = !tok.empty() && tok[0] == '-';
+            if (desc) tok.erase(0, 1);
+            std::transform(tok.begin(), tok.end(), tok.begin(), ::tolower);
+            SortField f;
+            bool ok = true;
+            if (tok == "price") f = SORT_PRICE;
+            else if (tok == "list") f = SORT_LIST_PRICE;
+            else if (tok == "size") f = SORT_SIZE;
+            else if (tok == "discount") f = SORT_DISCOUNT;
+            else if (tok == "name") f = SORT_NAME;
+            else ok = false;
+            if (ok) {
+                chain.parts.push_back({f, desc});
+                std::string pretty = tok; pretty[0] = (char)toupper((unsigned char)pretty[0]);
+                label += (label.empty() ? "" : ">") + pretty + (desc ? " v" : "");
+            }
+            if (p == std::string::npos) break;
+            start = p + 1;
+        }
+        if (chain.parts.empty()) continue;
+        // always finish with name so ties are deterministic
+        if (chain.parts.back().field != SORT_NAME) chain.parts.push_back({SORT_NAME, false});
+        chain.label = label;
+        chains.push_back(chain);
+    }
+}
+
+static inline int BitsFor(uint32_t maxValue) {
+    int bits = 0;
+    while (bits < 32 && (maxValue >> bits) != 0) ++bits;
+    return std::max(1, bits);
+}
+
+// Packs a product's chain values, most significant key first. Keys that have no value
+// (no price, no size) carry a leading "missing" bit so they always sort last, like before.
+// If the chain does not fit in 64 bits, the trailing keys lose their low bits (ties only).
+static uint64_t PackSortKey(const CatalogEntry &p, const SortChain &chain, int nameBits, int sizeBits) {
+    const int priceBits = 27; // cents, up to ~1.3M
+    uint64_t key = 0;
+    int used = 0;
+    auto push = [&](uint64_t v, int bits) {
+        if (used >= 64) return;
+        if (used + bits > 64) { v >>= (used + bits - 64); bits = 64 - used; }
+        key = (bits >= 64) ? v : ((key << bits) | v);
+        used += bits;
+    };
+    for (const auto &part : chain.parts) {
+        uint64_t v = 0; int bits = 0; bool missing = false; bool hasPresence = true;
+        switch (part.field) {
+            case SORT_LIST_PRICE:
+            case SORT_PRICE: {
+                missing = !p.hasPrice;
+                double pr = missing ? 0.0 : (part.field == SORT_PRICE ? EffectivePrice(p) : p.price);
+                double cents = std::round(pr * 100.0);
+                if (cents < 0) cents = 0;
+                if (cents > (double)((1u << priceBits) - 1)) cents = (double)((1u << priceBits) - 1);
+                v = (uint64_t)cents; bits = priceBits;
+                break;
+            }
+            case SORT_SIZE:
+                missing = !p.hasSize;
+                v = missing ? 0 : p.sizeOrd; bits = sizeBits;
+                break;
+            case SORT_DISCOUNT: {
+                double d = p.hasSale ? p.salePercent : 0.0;
+                if (d < 0) d = 0;
+                if (d > 100) d = 100;
+                v = (uint64_t)std::lround(d); bits = 7; hasPresence = false;
+                break;
+            }
+            case SORT_NAME:
+                v = p.nameRank; bits = nameBits; hasPresence = false;
+                break;
+        }
+        if (part.descending && !missing) v = ((bits >= 64) ? ~0ull : ((1ull << bits) - 1)) - v;
+        if (missing) v = 0;
+        if (hasPresence) push(missing ? 1 : 0, 1);
+        push(v, bits);
+    }
+    if (used < 64) key <<= (64 - used);
+    return key;
+}
+
+// Assigns dense nameRank/sizeOrd ordinals from the load pass's names and sizes (indexed like
+// products). Called once per catalog load. Fills nameOrder with the product indices in (name,
+// index) order and returns the distinct size labels, indexed by sizeOrd.
+static std::vector<std::string> RankProducts(std::vector<CatalogEntry> &products, const std::vector<std::string> &names,
+                                             const std::vector<std::string> &sizes, const SizeTaxonomy &taxonomy, std::vector<int> &nameOrder) {
+    std::vector<int> &order = nameOrder;
+    order.resize(products.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = (int)i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        int c = names[a].compare(names[b]);
+        return c != 0 ? c < 0 : a < b;
+    });
+    uint32_t rank = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i > 0 && names[order[i]] != names[order[i-1]]) ++rank;
+        products[order[i]].nameRank = rank;
+    }
+    // Size ordinals: taxonomy sizes in taxonomy order (aliases share an ordinal), then unknown
+    // sizes in natural order. Only sizes present in the catalog get an ordinal.
+    std::vector<int> rankOf(products.size(), -1);
+    std::vector<char> rankUsed(taxonomy.labels.size(), 0);
+    std::vector<std::string> unknown;
+    for (size_t i = 0; i < products.size(); ++i) {
+        if (sizes[i].empty()) continue;
+        rankOf[i] = taxonomy.Rank(sizes[i]);
+        if (rankOf[i] >= 0) rankUsed[rankOf[i]] = 1;
+        else unknown.push_back(SizeTaxonomy::Normalize(sizes[i]));
+    }
+    std::sort(unknown.begin(), unknown.end(), NaturalLess);
+    unknown.erase(std::unique(unknown.begin(), unknown.end()), unknown.end());
+    std::vector<std::string> labels;
+    std::vector<uint32_t> ordOfRank(taxonomy.labels.size(), 0);
+    for (size_t r = 0; r < rankUsed.size(); ++r) if (rankUsed[r]) { ordOfRank[r] = (uint32_t)labels.size(); labels.push_back(taxonomy.labels[r]); }
+    uint32_t unknownBase = (uint32_t)labels.size();
+    std::vector<std::string> unknownLabels(unknown.size());
+    for (size_t i = 0; i < products.size(); ++i) {
+        auto &p = products[i];
+        if (sizes[i].empty()) { p.sizeOrd = 0; continue; }
+        if (rankOf[i] >= 0) { p.sizeOrd = ordOfRank[rankOf[i]]; continue; }
+        auto it = std::lower_bound(unknown.begin(), unknown.end(), SizeTaxonomy::Normalize(sizes[i]), NaturalLess);
+        size_t u = (size_t)(it - unknown.begin());
+        p.sizeOrd = unknownBase + (uint32_t)u;
+        if (unknownLabels[u].empty()) unknownLabels[u] = sizes[i];
+    }
+    labels.insert(labels.end(), unknownLabels.begin(), unknownLabels.end());
+    return labels;
+}
+
+// The in-memory columns of a freshly parsed product; the ordinals are assigned by RankProducts
+static CatalogEntry MakeCatalogEntry(const Product &p) {
+    CatalogEntry e;
+    e.price = p.price; e.hasPrice = p.hasPrice;
+    e.salePercent = p.salePercent; e.hasSale = p.hasSale;
+    e.hasSize = !p.size.empty();
+    e.fileIndex = p.fileIndex;
+    e.catMask = CategoryMask(p);
+    e.groupMask = GroupMask(p);
+    return e;
+}
+
+// Per-frame GPU submission counters. The app renders through its own rlgl render batch so its
+// draw-call list can be read before every flush; call Flush() wherever raylib would otherwise
+// flush implicitly (before BeginTextureMode/EndTextureMode) and EndFrame() before EndDrawing.
+// Flushes forced by rlgl itself (256 draw calls or a full vertex buffer) are not counted.
+struct DrawStats {
+    rlRenderBatch batch = {};
+    bool ready = false;
+    unsigned drawCalls = 0, vertices = 0, textureSwitches = 0;
+    unsigned lastTextureId = 0;
+    // Totals of the last completed frame
+    unsigned frameDrawCalls = 0, frameVertices = 0, frameTextureSwitches = 0;
+
+    void Init() { batch = rlLoadRenderBatch(1, 8192); rlSetRenderBatchActive(&batch); ready = true; }
+    void Shutdown() {
+        if (!ready) return;
+        rlSetRenderBatchActive(NULL);
+        rlUnloadRenderBatch(batch);
+        ready = false;
+    }
+    void Flush() {
+        if (!ready) return;
+        for (int i = 0; i < batch.drawCounter; ++i) {
+            const rlDrawCall &d = batch.draws[i];
+            if (d.vertexCount == 0) continue;
+            drawCalls++;
+            vertices += (unsigned)d.vertexCount;
+            if (d.textureId != lastTextureId) { if (lastTextureId != 0) textureSwitches++; lastTextureId = d.textureId; }
+        }
+        rlDrawRenderBatchActive();
+    }
+    void EndFrame() {
+        Flush();
+        frameDrawCalls = drawCalls; frameVertices = vertices; frameTextureSwitches = textureSwitches;
+        drawCalls = vertices = textureSwitches = 0;
+        lastTextureId = 0;
+    }
+};
+DrawStats gDrawStats;
+
+// Fonts used by scaled helpers: the TTF is rasterized at a few pixel sizes and each draw uses
+// the smallest size >= the requested one, so text is only ever scaled down slightly. A rasterized
+// size is stored next to the TTF (<ttf>.<px>.png + <ttf>.<px>.txt with the glyph metrics) and
+// later runs load that instead of rasterizing again. Sizes are loaded on first use.
+//
+// The atlases hold ASCII only. Other codepoints (ç, ã, ê, ...) are rasterized from the TTF the
+// first time a string containing them is measured or drawn, shelf-packed into rows appended below
+// the ASCII glyphs, and uploaded once per size right before the next draw with that size.
+struct FontAtlasCache {
+    static const int kSizeCount = 10;
+    const int sizes[kSizeCount] = { 12, 16, 20, 24, 32, 40, 48, 64, 96, 128 };
+    std::string ttfPath;
+    Font fonts[kSizeCount] = {};
+    bool loaded[kSizeCount] = {};
+    bool usingDefault[kSizeCount] = {}; // TTF missing: raylib's default font, not ours to unload
+
+    // On-demand glyph state per size
+    Image atlases[kSizeCount] = {};                  // CPU copy of each atlas (GRAY_ALPHA)
+    std::unordered_set<int> extraGlyphs[kSizeCount]; // non-ASCII codepoints already added
+    int shelfX[kSizeCount] = {}, shelfY[kSizeCount] = {}, shelfH[kSizeCount] = {};
+    bool dirty[kSizeCount] = {};                     // atlas changed since the last upload
+    bool resized[kSizeCount] = {};                   // atlas grew: texture must be recreated
+    Rectangle whiteRecs[kSizeCount] = {};            // white pixel for SetShapesTexture
+    unsigned char *ttfData = NULL;
+    int ttfSize = 0;
+
+    void Init(const std::string &path) { Unload(); ttfPath = path; }
+
+    int Bucket(int px) const {
+        int b = 0;
+        while (b < kSizeCount - 1 && sizes[b] < px) ++b;
+        return b;
+    }
+
+    const Font &ForSize(int px) {
+        int b = Bucket(px);
+        if (!loaded[b]) { fonts[b] = LoadSize(b); loaded[b] = true; }
+        return fonts[b];
+    }
+
+    // Font for drawing/measuring text at px, with any missing codepoints of text added first.
+    // Measuring only needs the metrics; pass upload = true before drawing.
+    const Font &ForText(int px, const char *text, bool upload) {
+        int b = Bucket(px);
+        const Font &font = ForSize(px);
+        bool ascii = true;
+        for (const char *c = text; *c; ++c) if ((unsigned char)*c >= 0x80) { ascii = false; break; }
+        if (!ascii && atlases[b].data != NULL) {
+            for (const char *c = text; *c; ) {
+                int bytes = 0;
+                int cp = GetCodepointNext(c, &bytes);
+                c += bytes > 0 ? bytes : 1;
+                if (cp >= 0x80 && extraGlyphs[b].insert(cp).second) AddGlyph(b, cp);
+            }
+        }
+        if (upload && dirty[b]) Upload(b);
+        return font;
+    }
+
+    void Unload() {
+        for (int b = 0; b < kSizeCount; ++b) {
+            if (loaded[b] && !usingDefault[b]) {
+                gBackend->UnloadTexture(fonts[b].texture);
+                UnloadFontData(fonts[b].glyphs, fonts[b].glyphCount);
+                MemFree(fonts[b].recs);
+            }
+            usingDefault[b] = false;
+            if (atlases[b].data != NULL) UnloadImage(atlases[b]);
+            atlases[b] = Image{};
+            extraGlyphs[b].clear();
+            dirty[b] = resized[b] = false;
+            loaded[b] = false;
+            fonts[b] = Font{};
+        }
+        if (ttfData != NULL) { UnloadFileData(ttfData); ttfData = NULL; ttfSize = 0; }
+    }
+
+    void AddGlyph(int b, int cp) {
+        if (ttfData == NULL) ttfData = LoadFileData(ttfPath.c_str(), &ttfSize);
+        if (ttfData == NULL) return;
+        int count = 0;
+        GlyphInfo *rasterized = LoadFontData(ttfData, ttfSize, sizes[b], &cp, 1, FONT_DEFAULT, &count);
+        if (rasterized == NULL || count == 0) return;
+        GlyphInfo glyph = rasterized[0];
+        Image &atlas = atlases[b];
+        Font &font = fonts[b];
+        int pad = font.glyphPadding;
+        int w = glyph.image.width, h = glyph.image.height;
+
+        // Shelf packing in the rows below the ASCII glyphs; grow the atlas when it runs out
+        if (shelfX[b] + w + 2*pad > atlas.width) { shelfY[b] += shelfH[b]; shelfX[b] = 0; shelfH[b] = 0; }
+        if (shelfY[b] + h + 2*pad > atlas.height) {
+            int grow = std::max(h + 2*pad, sizes[b] * 4);
+            ImageResizeCanvas(&atlas, atlas.width, atlas.height + grow, 0, 0, BLANK);
+            resized[b] = true;
+        }
+        int x = shelfX[b] + pad, y = shelfY[b] + pad;
+        // Same pixel layout as GenImageFontAtlas: gray 255, coverage in alpha
+        unsigned char *dst = (unsigned char *)atlas.data;
+        const unsigned char *src = (const unsigned char *)glyph.image.data;
+        for (int gy = 0; gy < h && src != NULL; ++gy)
+            for (int gx = 0; gx < w; ++gx) {
+                int k = ((y + gy) * atlas.width + (x + gx)) * 2;
+                dst[k] = 255;
+                dst[k + 1] = src[gy * w + gx];
+            }
+        shelfX[b] += w + 2*pad;
+        shelfH[b] = std::max(shelfH[b], h + 2*pad);
+
+        font.glyphs = (GlyphInfo *)MemRealloc(font.glyphs, (font.glyphCount + 1) * sizeof(GlyphInfo));
+        font.recs = (Rectangle *)MemRealloc(font.recs, (font.glyphCount + 1) * sizeof(Rectangle));
+        font.glyphs[font.glyphCount] = GlyphInfo{ glyph.value, glyph.offsetX, glyph.offsetY, glyph.advanceX, Image{} };
+        font.recs[font.glyphCount] = Rectangle{ (float)x, (float)y, (float)w, (float)h };
+        font.glyphCount++;
+        UnloadFontData(rasterized, count);
+        dirty[b] = true;
+    }
+
+    void Upload(int b) {
+        Font &font = fonts[b];
+        if (resized[b]) {
+            // Vertices already queued this frame reference the old texture id: draw them before
+            // it goes away (or they render blank, and get baked into a static layer pass)
+            gDrawStats.Flush();
+            unsigned int oldId = font.texture.id;
+            gBackend->UnloadTexture(font.texture);
+            font.texture = gBackend->LoadTextureFromImage(atlases[b]);
+            gBackend->SetTextureFilter(font.texture, TEXTURE_FILTER_BILINEAR);
+            if (gBackend->GetShapesTexture().id == oldId) gBackend->SetShapesTexture(font.texture, whiteRecs[b]);
+        } else {
+            gBackend->UpdateTexture(font.texture, atlases[b].data);
+        }
+        dirty[b] = resized[b] = false;
+    }
+
+    // Identifies the TTF the cache was built from, so a replaced font is rasterized again
+    std::string SourceStamp() const {
+        std::ifstream f(ttfPath, std::ios::binary | std::ios::ate);
+        return std::to_string(GetFileModTime(ttfPath.c_str())) + " " + std::to_string(f ? (long long)f.tellg() : -1LL);
+    }
+
+    Font LoadSize(int b) {
+        int px = sizes[b];
+        std::string base = ttfPath + "." + std::to_string(px);
+        Font font = LoadCached(base, px, atlases[b]);
+        if (font.glyphCount == 0) font = Rasterize(base, px, atlases[b]);
+        if (font.glyphCount == 0) { usingDefault[b] = true; return GetFontDefault(); }
+
+        // A 3x3 white block in a strip below the glyphs lets shapes be drawn from this texture
+        // (SetShapesTexture), so rows mixing rectangles and text need no texture switches
+        Image &atlas = atlases[b];
+        int stripY = atlas.height;
+        ImageResizeCanvas(&atlas, atlas.width, atlas.height + 4, 0, 0, BLANK);
+        unsigned char *px2 = (unsigned char *)atlas.data;
+        for (int y = 0; y < 3; ++y)
+            for (int x = 0; x < 3; ++x) { int k = ((stripY + y) * atlas.width + x) * 2; px2[k] = 255; px2[k + 1] = 255; }
+        whiteRecs[b] = Rectangle{ 1.0f, (float)(stripY + 1), 1.0f, 1.0f };
+
+        font.texture = gBackend->LoadTextureFromImage(atlas);
+        gBackend->SetTextureFilter(font.texture, TEXTURE_FILTER_BILINEAR);
+        shelfX[b] = 0; shelfY[b] = atlas.height; shelfH[b] = 0; // extra glyphs go below
+        return font;
+    }
+
+    Font LoadCached(const std::string &base, int px, Image &atlasOut) {
+        Font font = {};
+        std::ifstream in(base + ".txt");
+        if (!in || !FileExists((base + ".png").c_str())) return font;
+        std::string line, stamp;
+        std::getline(in, line); // header comment
+        if (!std::getline(in, stamp) || stamp != "source " + SourceStamp()) return font;
+        int size = 0, padding = 0, count = 0;
+        std::string kSize, kPadding, kGlyphs;
+        if (!(in >> kSize >> size >> kPadding >> padding >> kGlyphs >> count) || size != px || count <= 0) return font;
+        GlyphInfo *glyphs = (GlyphInfo *)MemAlloc(count * sizeof(GlyphInfo));
+        Rectangle *recs = (Rectangle *)MemAlloc(count * sizeof(Rectangle));
+        for (int i = 0; i < count; ++i) {
+            if (!(in >> glyphs[i].value >> recs[i].x >> recs[i].y >> recs[i].width >> recs[i].height
+                     >> glyphs[i].offsetX >> glyphs[i].offsetY >> glyphs[i].advanceX)) {
+                MemFree(glyphs); MemFree(recs);
+                return font;
+            }
+        }
+        Image atlas = LoadImage((base + ".png").c_str());
+        if (atlas.data == NULL) { MemFree(glyphs); MemFree(recs); return font; }
+        font.baseSize = px;
+        font.glyphCount = count;
+        font.glyphPadding = padding;
+        font.glyphs = glyphs;
+        font.recs = recs;
+        ImageFormat(&atlas, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA);
+        atlasOut = atlas;
+        return font;
+    }
+
+    // Same steps as LoadFontEx, keeping the atlas image so it can be written to the cache
+    Font Rasterize(const std::string &base, int px, Image &atlasOut) {
+        Font font = {};
+        int dataSize = 0;
+        unsigned char *data = LoadFileData(ttfPath.c_str(), &dataSize);
+        if (data == NULL) return font;
+        const int padding = 4;
+        int count = 0;
+        GlyphInfo *glyphs = LoadFontData(data, dataSize, px, NULL, 0, FONT_DEFAULT, &count);
+        UnloadFileData(data);
+        if (glyphs == NULL || count == 0) return font;
+        Rectangle *recs = NULL;
+        Image atlas = GenImageFontAtlas(glyphs, &recs, count, px, padding, 0);
+        font.baseSize = px;
+        font.glyphCount = count;
+        font.glyphPadding = padding;
+        font.glyphs = glyphs;
+        font.recs = recs;
+
+        // Best effort: a read-only install just rasterizes again next time
+        if (ExportImage(atlas, (base + ".png").c_str())) {
+            std::ofstream out(base + ".txt", std::ios::trunc);
+            out << "# Font atlas cache: value rec.x rec.y rec.w rec.h offsetX offsetY advanceX\n";
+            out << "source " << SourceStamp() << "\n";
+            out << "size " << px << " padding " << padding << " glyphs " << count << "\n";
+            for (int i = 0; i < count; ++i)
+                out << glyphs[i].value << " " << recs[i].x << " " << recs[i].y << " " << recs[i].width << " " << recs[i].height << " "
+                    << glyphs[i].offsetX << " " << glyphs[i].offsetY << " " << glyphs[i].advanceX << "\n";
+        }
+        atlasOut = atlas;
+        return font;
+    }
+};
+FontAtlasCache gFonts;
+
+// A sub-rectangle of a shared atlas texture (UI icons, product thumbnails)
+struct AtlasSprite {
+    Texture2D texture = {};
+    Rectangle source = {};
+};
+
+// Deferred text for a group of rows. Between BeginTextBatch and EndTextBatch, DrawTextScaled only
+// queues; shapes are drawn right away from the atlas of the group's main text size, and the queued
+// text is drawn at the end grouped by atlas, main size first. A list of rows then costs one draw
+// call for everything at the main size plus one per other size, instead of a texture switch per
+// rectangle/text pair.
+struct TextBatch {
+    struct Item { std::string text; int x, y, px; Color color; };
+    struct SpriteItem { AtlasSprite sprite; Rectangle dest; Color tint; };
+    std::vector<Item> items;
+    std::vector<SpriteItem> sprites; // drawn before the text, grouped by atlas
+    bool active = false;
+    int mainBucket = 0;
+    Texture2D prevShapesTexture = {};
+    Rectangle prevShapesRec = {};
+};
+TextBatch gTextBatch;
+
+// Frame profiler behind the F3 overlay. Sections are timed with ProfileScope; while the overlay is
+// off a scope is a single flag test, so the timers can stay in release builds.
+enum ProfileSection { PROF_INPUT, PROF_STATE, PROF_FILTER, PROF_LOAD, PROF_FILE_IO, PROF_PRESENT, PROF_COUNT };
+static const char *kProfileSectionNames[PROF_COUNT] = { "Input", "State update/draw", "  Filter + sort", "  Load products", "  File I/O", "Present + wait" };
+
+struct Profiler {
+    static const int kHistory = 240;
+    bool enabled = false;
+    double sectionTime[PROF_COUNT] = {};     // seconds, frame in progress
+    double lastSectionTime[PROF_COUNT] = {}; // seconds, last completed frame
+    float frameMs[kHistory] = {};            // full frame time (start to start)
+    float cpuMs[kHistory] = {};              // frame time minus present/wait
+    int historyPos = 0, historyCount = 0;
+    double frameStart = 0.0;
+
+    void BeginFrame() {
+        double now = gBackend->GetTime();
+        if (enabled && frameStart > 0.0) {
+            double frame = now - frameStart;
+            frameMs[historyPos] = (float)(frame * 1000.0);
+            cpuMs[historyPos] = (float)((frame - sectionTime[PROF_PRESENT]) * 1000.0);
+            historyPos = (historyPos + 1) % kHistory;
+            historyCount = std::min(historyCount + 1, kHistory);
+        }
+        for (int i = 0; i < PROF_COUNT; ++i) { lastSectionTime[i] = sectionTime[i]; sectionTime[i] = 0.0; }
+        frameStart = now;
+    }
+    void Toggle() {
+        enabled = !enabled;
+        historyPos = historyCount = 0;
+        frameStart = 0.0;
+    }
+    // Percentile (0..1) of the recorded history
+    float Percentile(const float *samples, float q) const {
+        if (historyCount == 0) return 0.0f;
+        std::vector<float> sorted(samples, samples + historyCount);
+        size_t k = std::min(sorted.size() - 1, (size_t)(q * (sorted.size() - 1) + 0.5f));
+        std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+        return sorted[k];
+    }
+};
+Profiler gProfiler;
+
+struct ProfileScope {
+    int section;
+    double start;
+    explicit ProfileScope(int s) : section(s), start(gProfiler.enabled ? gBackend->GetTime() : -1.0) {}
+    void End() {
+        if (start >= 0.0 && gProfiler.enabled) gProfiler.sectionTime[section] += gBackend->GetTime() - start;
+        start = -1.0;
+    }
+    ~ProfileScope() { End(); }
+};
+
+// Static screens are drawn in two passes: LAYER_STATIC renders everything once into a cached
+// render texture (buttons in their idle look, no input), LAYER_OVERLAY runs every frame on top of
+// it and only draws what can change without invalidating the layer (hovered buttons) while still
+// handling clicks. Everything else draws directly.
+enum LayerPass { LAYER_DIRECT, LAYER_STATIC, LAYER_OVERLAY };
+LayerPass gLayerPass = LAYER_DIRECT;
 
 // --- Scaled text helpers (use these anywhere instead of raw DrawText/MeasureText) ---
 static inline int ScaledFontSize(int baseFontSize) {
     // Reference UI built for 600px height; scale linearly with current screen height
-    return std::max(8, (int)(baseFontSize * ((float)GetScreenHeight() / 600.0f)));
+    return std::max(8, (int)(baseFontSize * ((float)gBackend->GetScreenHeight() / 600.0f)));
 }
 static inline void DrawTextScaled(const char *text, int x, int y, int baseFontSize, Color color) {
+    if (gLayerPass == LAYER_OVERLAY) return; // already in the cached layer
+    if (gTextBatch.active) { gTextBatch.items.push_back(TextBatch::Item{ text, x, y, ScaledFontSize(baseFontSize), color }); return; }
     Vector2 pos = {(float)x, (float)y};
     float fontSize = (float)ScaledFontSize(baseFontSize);
     float spacing = fontSize * 0.1f; // 10% of font size for proper spacing
-    DrawTextEx(gFont, text, pos, fontSize, spacing, color);
+    gBackend->DrawTextEx(gFonts.ForText((int)fontSize, text, true), text, pos, fontSize, spacing, color);
 }
+
+// Cache of measured text widths keyed by (text hash, scaled font size). MeasureTextEx walks every
+// glyph (with a linear glyph-index lookup per codepoint), and the same labels are measured many times
+// per frame for centering. Cleared when the screen height or the font changes.
+struct TextMeasureCache {
+    struct Entry { std::string text; int px; int width; };
+    std::unordered_map<uint64_t, Entry> entries;
+    int screenHeight = -1;
+    bool enabled = true;
+    // Per-frame counters (reset by BeginFrame), used by --bench-text
+    unsigned calls = 0;       // MeasureTextScaled calls
+    unsigned glyphWalks = 0;  // calls that reached MeasureTextEx
+    unsigned glyphsWalked = 0; // characters walked by those calls
+    static const size_t kMaxEntries = 4096;
+
+    static uint64_t Key(const char *text, int px) {
+        uint64_t h = 1469598103934665603ULL;
+        for (const char *c = text; *c; ++c) { h ^= (unsigned char)*c; h *= 1099511628211ULL; }
+        h ^= (uint64_t)(unsigned)px; h *= 1099511628211ULL;
+        return h;
+    }
+    void Clear() { entries.clear(); }
+    void BeginFrame() { calls = glyphWalks = glyphsWalked = 0; }
+};
+TextMeasureCache gTextMeasure;
+
 static inline int MeasureTextScaled(const char *text, int baseFontSize) {
-    float fontSize = (float)ScaledFontSize(baseFontSize);
+    int px = ScaledFontSize(baseFontSize);
+    float fontSize = (float)px;
     float spacing = fontSize * 0.1f; // Match spacing used in DrawTextScaled
-    return (int)MeasureTextEx(gFont, text, fontSize, spacing).x;
+    TextMeasureCache &cache = gTextMeasure;
+    cache.calls++;
+    if (!cache.enabled) {
+        cache.glyphWalks++;
+        cache.glyphsWalked += (unsigned)strlen(text);
+        return (int)MeasureTextEx(gFonts.ForText(px, text, false), text, fontSize, spacing).x;
+    }
+    int screenH = gBackend->GetScreenHeight();
+    if (screenH != cache.screenHeight) { cache.Clear(); cache.screenHeight = screenH; }
+    uint64_t key = TextMeasureCache::Key(text, px);
+    auto it = cache.entries.find(key);
+    if (it != cache.entries.end() && it->second.px == px && it->second.text == text) return it->second.width;
+    cache.glyphWalks++;
+    cache.glyphsWalked += (unsigned)strlen(text);
+    int width = (int)MeasureTextEx(gFonts.ForText(px, text, false), text, fontSize, spacing).x;
+    if (cache.entries.size() >= TextMeasureCache::kMaxEntries) cache.Clear();
+    cache.entries[key] = TextMeasureCache::Entry{ text, px, width };
+    return width;
+}
+
+static void BeginTextBatch(int mainBaseFontSize) {
+    int px = ScaledFontSize(mainBaseFontSize);
+    const Font &font = gFonts.ForSize(px);
+    gTextBatch.mainBucket = gFonts.Bucket(px);
+    gTextBatch.prevShapesTexture = gBackend->GetShapesTexture();
+    gTextBatch.prevShapesRec = gBackend->GetShapesTextureRectangle();
+    if (gFonts.whiteRecs[gTextBatch.mainBucket].width > 0) gBackend->SetShapesTexture(font.texture, gFonts.whiteRecs[gTextBatch.mainBucket]);
+    gTextBatch.items.clear();
+    gTextBatch.sprites.clear();
+    gTextBatch.active = true;
+}
+
+static void EndTextBatch() {
+    gTextBatch.active = false;
+    gBackend->SetShapesTexture(gTextBatch.prevShapesTexture, gTextBatch.prevShapesRec);
+    std::stable_sort(gTextBatch.sprites.begin(), gTextBatch.sprites.end(),
+                     [](const TextBatch::SpriteItem &a, const TextBatch::SpriteItem &b) { return a.sprite.texture.id < b.sprite.texture.id; });
+    for (const auto &sp : gTextBatch.sprites) gBackend->DrawTexturePro(sp.sprite.texture, sp.sprite.source, sp.dest, Vector2{ 0, 0 }, 0.0f, sp.tint);
+    gTextBatch.sprites.clear();
+    int mainBucket = gTextBatch.mainBucket;
+    auto order = [&](const TextBatch::Item &it) { int b = gFonts.Bucket(it.px); return b == mainBucket ? -1 : b; };
+    std::stable_sort(gTextBatch.items.begin(), gTextBatch.items.end(),
+                     [&](const TextBatch::Item &a, const TextBatch::Item &b) { return order(a) < order(b); });
+    for (const auto &it : gTextBatch.items) {
+        float fontSize = (float)it.px;
+        gBackend->DrawTextEx(gFonts.ForText(it.px, it.text.c_str(), true), it.text.c_str(), Vector2{ (float)it.x, (float)it.y }, fontSize, fontSize * 0.1f, it.color);
+    }
+    gTextBatch.items.clear();
+}
+
+// Draws a sprite scaled into dest. Inside a text batch it is queued and drawn at EndTextBatch
+// with the other sprites of its atlas, so a list of thumbnails costs one bind per atlas page.
+static void DrawSprite(const AtlasSprite &sprite, Rectangle dest, Color tint) {
+    if (gTextBatch.active) { gTextBatch.sprites.push_back(TextBatch::SpriteItem{ sprite, dest, tint }); return; }
+    gBackend->DrawTexturePro(sprite.texture, sprite.source, dest, Vector2{ 0, 0 }, 0.0f, tint);
+}
+
+// UI icons (logo, home) packed into one texture at startup: shelf packing with a 1px gap so
+// filtering never samples a neighbour
+struct IconAtlas {
+    Texture2D texture = {};
+    std::vector<std::string> files;
+    std::vector<AtlasSprite> sprites;
+
+    int Add(const char *file) { files.push_back(file); return (int)files.size() - 1; }
+    void Build() {
+        std::vector<Image> images;
+        int atlasW = 512;
+        for (const auto &f : files) { images.push_back(LoadImage(f.c_str())); atlasW = std::max(atlasW, images.back().width + 2); }
+        std::vector<Rectangle> placed(images.size());
+        int x = 1, y = 1, shelfH = 0;
+        for (size_t i = 0; i < images.size(); ++i) {
+            if (x + images[i].width + 1 > atlasW) { x = 1; y += shelfH + 1; shelfH = 0; }
+            placed[i] = Rectangle{ (float)x, (float)y, (float)images[i].width, (float)images[i].height };
+            x += images[i].width + 1;
+            shelfH = std::max(shelfH, images[i].height);
+        }
+        Image atlas = GenImageColor(atlasW, std::max(1, y + shelfH + 1), BLANK);
+        for (size_t i = 0; i < images.size(); ++i) {
+            if (images[i].data) ImageDraw(&atlas, images[i], Rectangle{ 0, 0, (float)images[i].width, (float)images[i].height }, placed[i], WHITE);
+            UnloadImage(images[i]);
+        }
+        texture = gBackend->LoadTextureFromImage(atlas);
+        UnloadImage(atlas);
+        sprites.clear();
+        for (const auto &r : placed) sprites.push_back(AtlasSprite{ texture, r });
+    }
+    void Unload() { if (texture.id != 0) gBackend->UnloadTexture(texture); texture = {}; }
+};
+
+// Preformatted text (prices, subtotals) with its measured width cached per scaled font size,
+// so steady-state frames neither format nor re-measure it
+struct TextLabel {
+    std::string text;
+    int fontPx = 0;
+    int width = 0;
+    int Width(int baseFontSize) {
+        int px = ScaledFontSize(baseFontSize);
+        if (px != fontPx) { width = MeasureTextScaled(text.c_str(), baseFontSize); fontPx = px; }
+        return width;
+    }
+};
+
+static std::string FormatMoney(double v, const char *prefix = "$") {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%s%.2f", prefix, v);
+    return buf;
+}
+
+// Greedy word wrap at the DrawTextScaled size. Each word is measured once and line widths are
+// accumulated (a joined string measures as the sum of its parts plus one spacing per join), so the
+// cost is linear in the text length instead of re-measuring every growing candidate line.
+static std::vector<std::string> WrapTextLines(const std::string &text, int baseFontSize, int maxWidth) {
+    std::vector<std::string> lines;
+    int px = ScaledFontSize(baseFontSize);
+    float fontSize = (float)px;
+    float spacing = fontSize * 0.1f;
+    const Font &font = gFonts.ForText(px, text.c_str(), false);
+    float spaceW = MeasureTextEx(font, " ", fontSize, spacing).x;
+    std::string lineBuf, word;
+    float lineW = 0.0f;
+    size_t i = 0, n = text.size();
+    while (i < n) {
+        while (i < n && isspace((unsigned char)text[i])) ++i;
+        size_t start = i;
+        while (i < n && !isspace((unsigned char)text[i])) ++i;
+        if (start == i) break;
+        word.assign(text, start, i - start);
+        float wordW = MeasureTextEx(font, word.c_str(), fontSize, spacing).x;
+        if (lineBuf.empty()) { lineBuf = word; lineW = wordW; continue; }
+        float tryW = lineW + spacing + spaceW + spacing + wordW;
+        if ((int)tryW > maxWidth) { lines.push_back(lineBuf); lineBuf = word; lineW = wordW; }
+        else { lineBuf += ' '; lineBuf += word; lineW = tryW; }
+    }
+    if (!lineBuf.empty()) lines.push_back(lineBuf);
+    return lines;
+}
+
+// Editable text field backed by a gap buffer: the text before the gap is [0, gapStart) and the text
+// after it is [gapEnd, buf.size()), so typing or deleting at the cursor only moves the gap edges.
+// Widths come from a per-font-size table of ASCII advances (MeasureTextEx of a run is the sum of
+// its glyph advances plus one spacing per join), and multi-line fields keep their wrapped line
+// starts, re-wrapping after an edit only until the new breaks line up with the old ones again.
+// Input is limited to printable ASCII like the rest of the forms.
+struct TextField {
+    std::vector<char> buf;
+    size_t gapStart = 0, gapEnd = 0;
+    size_t cursor = 0, anchor = 0; // selection is [min, max) of the two; empty when equal
+    size_t maxLength;
+    bool multiline;
+    bool masked = false;  // draw (and measure) every character as '*'; copy/cut disabled
+    bool dragging = false;
+    // Layout cache
+    int layoutPx = 0;
+    float advance[128] = {}, spacing = 0.0f;
+    int wrapWidth = 0;              // 0: never wrap
+    std::vector<size_t> lineStarts = { 0 };
+    size_t firstLine = 0;           // first line shown in a multi-line box
+
+    explicit TextField(size_t maxLen = 255, bool multi = false) : maxLength(maxLen), multiline(multi) {}
+
+    size_t Length() const { return buf.size() - (gapEnd - gapStart); }
+    bool Empty() const { return Length() == 0; }
+    char At(size_t i) const { return i < gapStart ? buf[i] : buf[i + (gapEnd - gapStart)]; }
+    std::string Text(size_t from = 0, size_t to = std::string::npos) const {
+        to = std::min(to, Length());
+        std::string out;
+        out.reserve(to > from ? to - from : 0);
+        for (size_t i = from; i < to; ++i) out.push_back(At(i));
+        return out;
+    }
+    void Set(const std::string &text) {
+        buf.assign(text.begin(), text.begin() + std::min(text.size(), maxLength));
+        gapStart = gapEnd = buf.size();
+        cursor = anchor = Length();
+        firstLine = 0;
+        Relayout();
+    }
+    void Clear() { Set(std::string()); }
+
+    // --- Gap buffer ---
+    void MoveGap(size_t pos) {
+        if (pos < gapStart) {
+            size_t n = gapStart - pos;
+            memmove(buf.data() + gapEnd - n, buf.data() + pos, n);
+            gapStart -= n; gapEnd -= n;
+        } else if (pos > gapStart) {
+            size_t n = pos - gapStart;
+            memmove(buf.data() + gapStart, buf.data() + gapEnd, n);
+            gapStart += n; gapEnd += n;
+        }
+    }
+    void Replace(size_t from, size_t to, const char *text, size_t n) {
+        n = std::min(n, maxLength - (Length() - (to - from)));
+        MoveGap(from);
+        gapEnd += to - from; // deleted chars fall into the gap
+        if (gapEnd - gapStart < n) {
+            size_t tail = buf.size() - gapEnd;
+            size_t cap = std::max(buf.size() * 2, buf.size() + n + 64);
+            std::vector<char> grown(cap);
+            memcpy(grown.data(), buf.data(), gapStart);
+            memcpy(grown.data() + cap - tail, buf.data() + gapEnd, tail);
+            buf.swap(grown);
+            gapEnd = cap - tail;
+        }
+        memcpy(buf.data() + gapStart, text, n);
+        gapStart += n;
+        cursor = anchor = from + n;
+        Rewrap(from, (long)n - (long)(to - from), n);
+    }
+    bool HasSelection() const { return cursor != anchor; }
+    size_t SelStart() const { return std::min(cursor, anchor); }
+    size_t SelEnd() const { return std::max(cursor, anchor); }
+
+    // --- Layout ---
+    float Adv(char c) const { return advance[masked ? '*' : ((unsigned char)c & 127)]; }
+    void UseFont(int baseFontSize) {
+        int px = ScaledFontSize(baseFontSize);
+        if (px == layoutPx) return;
+        layoutPx = px;
+        float fontSize = (float)px;
+        spacing = fontSize * 0.1f;
+        const Font &font = gFonts.ForText(px, "A", false);
+        char one[2] = { 0, 0 };
+        for (int c = 32; c < 127; ++c) { one[0] = (char)c; advance[c] = MeasureTextEx(font, one, fontSize, spacing).x; }
+        Relayout();
+    }
+    // Width of [from, to) on one line
+    float Width(size_t from, size_t to) const {
+        float w = 0.0f;
+        for (size_t i = from; i < to; ++i) w += Adv(At(i)) + (i > from ? spacing : 0.0f);
+        return w;
+    }
+    // Start of the line after the one starting at 'start': breaks after the last space that fits,
+    // or mid-word when a single word is wider than the box
+    size_t WrapFrom(size_t start) const {
+        size_t n = Length();
+        if (wrapWidth <= 0) return n;
+        float w = 0.0f;
+        size_t lastBreak = start;
+        for (size_t i = start; i < n; ++i) {
+            char c = At(i);
+            if (c == ' ') { lastBreak = i + 1; w += Adv(c) + spacing; continue; } // spaces may hang
+            float next = w + Adv(c) + (i > start ? spacing : 0.0f);
+            if (next > wrapWidth && i > start) return lastBreak > start ? lastBreak : i;
+            w = next;
+        }
+        return n;
+    }
+    void Relayout() {
+        lineStarts.assign(1, 0);
+        if (layoutPx == 0) return;
+        for (size_t next = WrapFrom(0); next < Length(); next = WrapFrom(next)) lineStarts.push_back(next);
+    }
+    // After replacing text at 'at' (inserted chars, length change 'delta'), re-wrap from the line
+    // before the edit and splice in the old starts, shifted, once a new break matches one of them
+    void Rewrap(size_t at, long delta, size_t inserted) {
+        if (layoutPx == 0 || wrapWidth <= 0) return;
+        std::vector<size_t> old;
+        old.swap(lineStarts);
+        size_t line = std::upper_bound(old.begin(), old.end(), at) - old.begin() - 1;
+        size_t from = line > 0 ? line - 1 : 0;
+        lineStarts.assign(old.begin(), old.begin() + from + 1);
+        size_t n = Length();
+        for (size_t next = WrapFrom(lineStarts.back()); next < n; next = WrapFrom(next)) {
+            lineStarts.push_back(next);
+            if (next < at + inserted) continue;
+            size_t oldPos = (size_t)((long)next - delta);
+            auto it = std::lower_bound(old.begin() + from, old.end(), oldPos);
+            if (it != old.end() && *it == oldPos) {
+                for (++it; it != old.end(); ++it) lineStarts.push_back((size_t)((long)*it + delta));
+                return;
+            }
+        }
+    }
+    size_t LineOf(size_t pos) const { return std::upper_bound(lineStarts.begin(), lineStarts.end(), pos) - lineStarts.begin() - 1; }
+    size_t LineEnd(size_t line) const { return line + 1 < lineStarts.size() ? lineStarts[line + 1] : Length(); }
+    // Last cursor position on 'line': a wrapped line's trailing break space belongs to the next
+    // line; a line broken mid-word has no such space and ends at the next line's start
+    size_t CaretEnd(size_t line) const {
+        size_t end = LineEnd(line);
+        if (line + 1 < lineStarts.size() && end > lineStarts[line] && At(end - 1) == ' ') --end;
+        return end;
+    }
+    // Position on 'line' nearest to x pixels from the line start
+    size_t HitTest(size_t line, float x) const {
+        size_t pos = lineStarts[line], end = CaretEnd(line);
+        float w = 0.0f;
+        for (; pos < end; ++pos) {
+            float a = Adv(At(pos)) + spacing;
+            if (x < w + a * 0.5f) break;
+            w += a;
+        }
+        return pos;
+    }
+
+    // --- Input ---
+    void MoveCursor(size_t pos, bool extend) { cursor = pos; if (!extend) anchor = pos; }
+    // Typing, deletion, cursor keys, select all and clipboard. Returns true when the text changed.
+    bool HandleKeys() {
+        bool changed = false;
+        bool ctrl = gBackend->IsKeyDown(KEY_LEFT_CONTROL) || gBackend->IsKeyDown(KEY_RIGHT_CONTROL) || gBackend->IsKeyDown(KEY_LEFT_SUPER);
+        bool shift = gBackend->IsKeyDown(KEY_LEFT_SHIFT) || gBackend->IsKeyDown(KEY_RIGHT_SHIFT);
+        auto pressed = [](int key) { return gBackend->IsKeyPressed(key) || gBackend->IsKeyPressedRepeat(key); };
+        for (int key = gBackend->GetCharPressed(); key > 0; key = gBackend->GetCharPressed()) {
+            if (key < 32 || key > 125) continue;
+            char c = (char)key;
+            Replace(SelStart(), SelEnd(), &c, 1);
+            changed = true;
+        }
+        if (pressed(KEY_BACKSPACE)) {
+            if (HasSelection()) Replace(SelStart(), SelEnd(), "", 0);
+            else if (cursor > 0) Replace(cursor - 1, cursor, "", 0);
+            changed = true;
+        }
+        if (pressed(KEY_DELETE)) {
+            if (HasSelection()) Replace(SelStart(), SelEnd(), "", 0);
+            else if (cursor < Length()) Replace(cursor, cursor + 1, "", 0);
+            changed = true;
+        }
+        if (pressed(KEY_LEFT)) MoveCursor(HasSelection() && !shift ? SelStart() : (cursor > 0 ? cursor - 1 : 0), shift);
+        if (pressed(KEY_RIGHT)) MoveCursor(HasSelection() && !shift ? SelEnd() : std::min(cursor + 1, Length()), shift);
+        if (pressed(KEY_HOME)) MoveCursor(ctrl || !multiline ? 0 : lineStarts[LineOf(cursor)], shift);
+        if (pressed(KEY_END)) {
+            MoveCursor(ctrl || !multiline ? Length() : CaretEnd(LineOf(cursor)), shift);
+        }
+        if (multiline && (pressed(KEY_UP) || pressed(KEY_DOWN))) {
+            size_t line = LineOf(cursor);
+            float x = Width(lineStarts[line], cursor);
+            if (pressed(KEY_UP) && line > 0) MoveCursor(HitTest(line - 1, x), shift);
+            else if (pressed(KEY_DOWN) && line + 1 < lineStarts.size()) MoveCursor(HitTest(line + 1, x), shift);
+        }
+        if (ctrl && gBackend->IsKeyPressed(KEY_A)) { anchor = 0; cursor = Length(); }
+        if (ctrl && !masked && HasSelection() && (gBackend->IsKeyPressed(KEY_C) || gBackend->IsKeyPressed(KEY_X))) {
+            gBackend->SetClipboardText(Text(SelStart(), SelEnd()).c_str());
+            if (gBackend->IsKeyPressed(KEY_X)) { Replace(SelStart(), SelEnd(), "", 0); changed = true; }
+        }
+        if (ctrl && gBackend->IsKeyPressed(KEY_V)) {
+            const char *clip = gBackend->GetClipboardText();
+            std::string paste;
+            for (const char *p = clip ? clip : ""; *p; ++p) {
+                unsigned char c = (unsigned char)*p;
+                if (c == '\n' || c == '\t') paste.push_back(' '); // fields are stored on one line
+                else if (c >= 32 && c <= 125) paste.push_back((char)c);
+            }
+            Replace(SelStart(), SelEnd(), paste.data(), paste.size());
+            changed = true;
+        }
+        return changed;
+    }
+    // Click places the cursor, shift-click and drag extend the selection
+    void HandleMouse(Rectangle box, int baseFontSize) {
+        UseFont(baseFontSize);
+        Vector2 m = gBackend->GetMousePosition();
+        bool pressedInside = gBackend->IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(m, box);
+        if (pressedInside) dragging = true;
+        if (!gBackend->IsMouseButtonDown(MOUSE_LEFT_BUTTON)) dragging = false;
+        if (!pressedInside && !dragging) return;
+        float lineH = LineHeight();
+        long row = multiline ? (long)std::floor((m.y - box.y - kPad) / lineH) + (long)firstLine : 0;
+        size_t line = (size_t)std::min(std::max(row, 0L), (long)lineStarts.size() - 1);
+        bool shift = gBackend->IsKeyDown(KEY_LEFT_SHIFT) || gBackend->IsKeyDown(KEY_RIGHT_SHIFT);
+        MoveCursor(HitTest(line, m.x - box.x - kPad), shift || !pressedInside);
+    }
+
+    // --- Drawing ---
+    static constexpr float kPad = 6.0f;
+    float LineHeight() const { return (float)layoutPx * 1.25f; }
+    // Draws the visible lines with selection and caret; the caller draws the box and focus border
+    void Draw(Rectangle box, int baseFontSize, Color textColor, bool focused) {
+        UseFont(baseFontSize);
+        if (multiline) {
+            int w = std::max(1, (int)(box.width - 2 * kPad));
+            if (w != wrapWidth) { wrapWidth = w; Relayout(); }
+        }
+        float lineH = LineHeight();
+        size_t visibleLines = multiline ? std::max<size_t>(1, (size_t)((box.height - 2 * kPad) / lineH)) : 1;
+        size_t cursorLine = LineOf(cursor);
+        if (cursorLine < firstLine) firstLine = cursorLine;
+        if (cursorLine >= firstLine + visibleLines) firstLine = cursorLine - visibleLines + 1;
+        if (firstLine >= lineStarts.size()) firstLine = lineStarts.size() - 1;
+        size_t lastLine = std::min(lineStarts.size(), firstLine + visibleLines);
+        size_t selA = SelStart(), selB = SelEnd();
+        std::string lineText;
+        for (size_t line = firstLine; line < lastLine; ++line) {
+            size_t start = lineStarts[line], end = LineEnd(line);
+            float y = box.y + kPad + (float)(line - firstLine) * lineH;
+            if (focused && selA < selB && selA < end && selB > start) {
+                size_t a = std::max(selA, start), b = std::min(selB, end);
+                float x0 = Width(start, a) + (a > start ? spacing : 0.0f);
+                gBackend->DrawRectangleRec(Rectangle{ box.x + kPad + x0, y, std::max(Width(a, b), 2.0f), (float)layoutPx }, Fade(SKYBLUE, 0.6f));
+            }
+            lineText = masked ? std::string(end - start, '*') : Text(start, end);
+            DrawTextScaled(lineText.c_str(), (int)(box.x + kPad), (int)y, baseFontSize, textColor);
+        }
+        if (focused && cursorLine >= firstLine && cursorLine < lastLine) {
+            size_t start = lineStarts[cursorLine];
+            float x = box.x + kPad + Width(start, cursor) + (cursor > start ? spacing * 0.5f : 0.0f);
+            float y = box.y + kPad + (float)(cursorLine - firstLine) * lineH;
+            gBackend->DrawRectangleRec(Rectangle{ x, y, 2.0f, (float)layoutPx }, textColor);
+        }
+    }
+};
+
+// Display strings for one product: list price and sale price
+struct ProductLabels { TextLabel price; TextLabel sale; };
+
+// --- Paged catalog rows ---
+// Products in memory keep only fixed-width columns (CatalogEntry); the text columns (name, size,
+// fabric, sex, description) stay in the catalog file. LoadProducts writes two files next to it:
+// <catalog>.idx with the byte offset of every product line, and <catalog>.names with the lowercase
+// names in product order, one per line, which name searches stream through. The product list reads
+// the rows it shows a page at a time (consecutive positions of the current view) through a small
+// LRU. Row data held in memory is bounded by kMaxPages * kPageRows whatever the catalog size.
+struct CatalogRow { ProductLabels labels; std::string name, size, fabric, sex, description; };
+
+struct CatalogPages {
+    static constexpr size_t kPageRows = 64;
+    static constexpr size_t kMaxPages = 16;
+    struct Page { unsigned view = 0; size_t first = 0; uint64_t lastUse = 0; std::vector<CatalogRow> rows; };
+    std::string catalogPath, indexPath;
+    std::ifstream catalog, index;
+    std::vector<Page> pages;
+    uint64_t useClock = 0;
+    size_t pageLoads = 0;
+
+    static std::string IndexPathFor(const std::string &path) { return path + ".idx"; }
+    static std::string NamesPathFor(const std::string &path) { return path + ".names"; }
+    // Drops every page and the open file handles (before the catalog or its index is rewritten)
+    void Close() {
+        pages.clear();
+        if (catalog.is_open()) catalog.close();
+        if (index.is_open()) index.close();
+        catalog.clear(); index.clear();
+    }
+    void Open(const std::string &path) {
+        Close();
+        catalogPath = path;
+        indexPath = IndexPathFor(path);
+        pages.reserve(kMaxPages); // rows handed out stay valid until their page is evicted
+    }
+    // Reads product line `fileIndex` through the offset index
+    bool ReadLine(int fileIndex, std::string &line) {
+        if (!index.is_open()) index.open(indexPath, std::ios::binary);
+        if (!catalog.is_open()) catalog.open(catalogPath, std::ios::binary);
+        if (!index.is_open() || !catalog.is_open()) return false;
+        uint64_t offset = 0;
+        index.clear();
+        index.seekg((std::streamoff)fileIndex * (std::streamoff)sizeof(offset));
+        if (!index.read((char *)&offset, sizeof(offset))) return false;
+        catalog.clear();
+        catalog.seekg((std::streamoff)offset);
+        if (!std::getline(catalog, line)) return false;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        return true;
+    }
+    // The full product (text columns included) for one catalog line
+    bool ReadProduct(int fileIndex, Product &out) {
+        std::string line;
+        if (!ReadLine(fileIndex, line)) return false;
+        out = ParseProductLine(line, fileIndex);
+        return true;
+    }
+    // Sets bit i of `out` for every product i (of `count`) whose lowercase name contains `term`.
+    // Streams the names file through one read buffer. Returns false if the file is missing or short.
+    bool MatchNames(const std::string &term, size_t count, Bitmap &out) const {
+        out.Reset(count);
+        std::ifstream names(NamesPathFor(catalogPath), std::ios::binary);
+        if (!names) return false;
+        std::vector<char> buf(1 << 16);
+        std::string split; // a name cut by the end of a read
+        size_t i = 0;
+        while (i < count && names) {
+            names.read(buf.data(), (std::streamsize)buf.size());
+            const char *p = buf.data(), *end = p + names.gcount();
+            while (p < end) {
+                const char *nl = (const char *)memchr(p, '\n', (size_t)(end - p));
+                if (!nl) { split.append(p, end); break; }
+                const char *b = p, *e = nl;
+                if (!split.empty()) { split.append(p, nl); b = split.data(); e = b + split.size(); }
+                if (i < count && std::search(b, e, term.begin(), term.end()) != e) out.Set(i);
+                ++i; split.clear(); p = nl + 1;
+            }
+        }
+        return i >= count;
+    }
+    // Row `row` of view `view` (rowCount rows); productAt(row) returns that row's CatalogEntry
+    template <typename ProductAt>
+    CatalogRow &Get(unsigned view, size_t row, size_t rowCount, const ProductAt &productAt) {
+        Page &page = Load(view, row - row % kPageRows, rowCount, productAt);
+        return page.rows[row - page.first];
+    }
+    // Loads the page holding `row` ahead of time (no-op when cached or out of range)
+    template <typename ProductAt>
+    void Prefetch(unsigned view, size_t row, size_t rowCount, const ProductAt &productAt) {
+        if (row < rowCount) Load(view, row - row % kPageRows, rowCount, productAt);
+    }
+    template <typename ProductAt>
+    Page &Load(unsigned view, size_t first, size_t rowCount, const ProductAt &productAt) {
+        ++useClock;
+        for (auto &p : pages) if (p.view == view && p.first == first) { p.lastUse = useClock; return p; }
+        Page *slot = nullptr;
+        if (pages.size() < kMaxPages) { pages.emplace_back(); slot = &pages.back(); }
+        else slot = &*std::min_element(pages.begin(), pages.end(), [](const Page &a, const Page &b) { return a.lastUse < b.lastUse; });
+        slot->view = view; slot->first = first; slot->lastUse = useClock;
+        slot->rows.clear();
+        size_t end = std::min(rowCount, first + kPageRows);
+        Product full;
+        for (size_t r = first; r < end; ++r) {
+            const CatalogEntry &p = productAt(r);
+            CatalogRow row;
+            if (p.hasPrice) {
+                row.labels.price.text = FormatMoney(p.price);
+                if (p.hasSale) row.labels.sale.text = FormatMoney(EffectivePrice(p));
+            }
+            if (ReadProduct(p.fileIndex, full)) {
+                row.name.swap(full.name); row.size.swap(full.size);
+                row.fabric.swap(full.fabric); row.sex.swap(full.sex); row.description.swap(full.description);
+            }
+            slot->rows.push_back(std::move(row));
+        }
+        ++pageLoads;
+        return *slot;
+    }
+};
+
+// --- Product thumbnails ---
+// Optional images in data/images/, one per product, named after it: lowercase, every character
+// other than a letter or digit replaced by '_', plus ".png". Files are decoded and shrunk on a
+// small background pool. The main thread copies finished ones into fixed slots of shared atlas
+// pages within a per-frame time budget, so a screen of thumbnails draws from one or two textures.
+// The number of pages is capped by memory; when all slots are taken the least recently drawn
+// thumbnail gives up its slot. Queued requests for rows that scrolled away before their decode
+// started are cancelled, and "no image" results are forgotten once their rows are off screen, so
+// the entry map tracks recently shown products rather than every product ever scrolled past.
+struct ThumbnailCache {
+    static constexpr int kThumbPx = 128;                    // decoded images are shrunk to fit this square
+    static constexpr int kPagePx = 2048;                    // atlas page size
+    static constexpr int kSlotPitch = kThumbPx + 2;         // 1px gap around each slot against filter bleed
+    static constexpr int kSlotsPerRow = kPagePx / kSlotPitch;
+    static constexpr int kSlotsPerPage = kSlotsPerRow * kSlotsPerRow;
+    static constexpr size_t kPageBytes = (size_t)kPagePx * kPagePx * 4;
+    static constexpr int kStaleFrames = 30;                 // queued requests and missing results not asked for in this many frames are dropped
+    enum Status { QUEUED, READY, MISSING };
+    struct Entry {
+        Status status = QUEUED;
+        int slot = -1; // page * kSlotsPerPage + slot within the page
+        AtlasSprite sprite;
+        uint64_t lastUse = 0;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+        std::list<std::string>::iterator lruPos; // READY only
+    };
+    struct Decoded { std::string path; Image image; bool ok; };
+
+    std::string directory;
+    bool enabled = false;
+    size_t memoryCap = 48u << 20;
+    size_t memoryUsed = 0;
+    size_t queued = 0;
+    std::unordered_map<std::string, Entry> entries; // by image path
+    std::list<std::string> lru;                      // paths of READY entries, most recently drawn first
+    std::vector<Texture2D> pages;
+    std::vector<int> freeSlots;
+    std::unique_ptr<ThreadPool> decoders;
+    std::mutex doneMutex;
+    std::vector<Decoded> done; // filled by the decoders, drained by Update
+    uint64_t frame = 0;
+    size_t uploads = 0, evictions = 0;
+
+    void Init(const std::string &dir) {
+        directory = dir;
+        enabled = DirectoryExists(dir.c_str());
+        if (enabled) decoders.reset(new ThreadPool(std::max(1u, std::min(4u, std::thread::hardware_concurrency() / 2))));
+    }
+    static std::string FileNameFor(const std::string &productName) {
+        std::string file;
+        for (unsigned char c : productName) file += isalnum(c) ? (char)tolower(c) : '_';
+        return file + ".png";
+    }
+    bool Busy() const { return queued > 0; }
+
+    // Thumbnail for a product, or nullptr while it loads (loading set) or when it has no image
+    const AtlasSprite *Get(const std::string &productName, bool *loading = nullptr) {
+        if (loading) *loading = false;
+        if (!enabled) return nullptr;
+        std::string path = directory + "/" + FileNameFor(productName);
+        auto it = entries.find(path);
+        if (it == entries.end()) {
+            Entry e;
+            e.cancelled = std::make_shared<std::atomic<bool>>(false);
+            std::shared_ptr<std::atomic<bool>> cancelled = e.cancelled;
+            it = entries.emplace(path, std::move(e)).first;
+            ++queued;
+            decoders->Submit([this, path, cancelled]() {
+                if (cancelled->load()) return;
+                Decoded d{ path, Image{}, false };
+                if (FileExists(path.c_str())) {
+                    d.image = LoadImage(path.c_str());
+                    if (d.image.data && d.image.width > 0 && d.image.height > 0) {
+                        float scale = std::min(1.0f, (float)kThumbPx / (float)std::max(d.image.width, d.image.height));
+                        if (scale < 1.0f) ImageResize(&d.image, std::max(1, (int)(d.image.width * scale)), std::max(1, (int)(d.image.height * scale)));
+                        ImageFormat(&d.image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8); // the atlas pages' format
+                        d.ok = true;
+                    } else if (d.image.data) {
+                        UnloadImage(d.image);
+                    }
+                }
+                std::lock_guard<std::mutex> lock(doneMutex);
+                done.push_back(d);
+            });
+        }
+        Entry &e = it->second;
+        if (e.status == READY && e.lastUse != frame) lru.splice(lru.begin(), lru, e.lruPos);
+        e.lastUse = frame;
+        if (loading) *loading = e.status == QUEUED;
+        return e.status == READY ? &e.sprite : nullptr;
+    }
+
+    Rectangle SlotRect(int slot) const {
+        int inPage = slot % kSlotsPerPage;
+        return Rectangle{ (float)(1 + (inPage % kSlotsPerRow) * kSlotPitch), (float)(1 + (inPage / kSlotsPerRow) * kSlotPitch), (float)kThumbPx, (float)kThumbPx };
+    }
+    // A free slot: unused, on a new page while under the memory cap, or taken from the least
+    // recently drawn thumbnail. -1 when every slot was drawn in the last frame.
+    int AllocSlot() {
+        if (freeSlots.empty() && (pages.empty() || memoryUsed + kPageBytes <= memoryCap)) {
+            Image blank = GenImageColor(kPagePx, kPagePx, BLANK);
+            Texture2D page = gBackend->LoadTextureFromImage(blank);
+            UnloadImage(blank);
+            gBackend->SetTextureFilter(page, TEXTURE_FILTER_BILINEAR);
+            int base = (int)pages.size() * kSlotsPerPage;
+            pages.push_back(page);
+            memoryUsed += kPageBytes;
+            for (int k = kSlotsPerPage - 1; k >= 0; --k) freeSlots.push_back(base + k);
+        }
+        if (!freeSlots.empty()) { int slot = freeSlots.back(); freeSlots.pop_back(); return slot; }
+        if (lru.empty()) return -1;
+        auto victim = entries.find(lru.back());
+        if (victim->second.lastUse + 1 >= frame) return -1; // least recent one is still on screen
+        int slot = victim->second.slot;
+        entries.erase(victim);
+        lru.pop_back();
+        ++evictions;
+        return slot;
+    }
+
+    // Once per frame, before drawing: copy decoded images into atlas slots until the budget is
+    // spent and drop stale queued requests
+    void Update(double budgetSeconds) {
+        if (!enabled) return;
+        ++frame;
+        std::vector<Decoded> ready;
+        {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            ready.swap(done);
+        }
+        double start = gBackend->GetTime();
+        size_t i = 0;
+        for (; i < ready.size(); ++i) {
+            if (i > 0 && gBackend->GetTime() - start > budgetSeconds) break;
+            Decoded &d = ready[i];
+            auto it = entries.find(d.path);
+            if (it == entries.end() || it->second.status != QUEUED) { if (d.ok) UnloadImage(d.image); continue; }
+            Entry &e = it->second;
+            if (!d.ok) { e.status = MISSING; --queued; continue; }
+            int slot = AllocSlot();
+            if (slot < 0) break; // atlas full of on-screen thumbnails; retry next frame
+            Rectangle rect = SlotRect(slot);
+            rect.width = (float)d.image.width;
+            rect.height = (float)d.image.height;
+            Texture2D page = pages[slot / kSlotsPerPage];
+            gBackend->UpdateTextureRec(page, rect, d.image.data);
+            e.slot = slot;
+            e.sprite = AtlasSprite{ page, rect };
+            e.status = READY;
+            lru.push_front(d.path);
+            e.lruPos = lru.begin();
+            --queued;
+            UnloadImage(d.image);
+            ++uploads;
+        }
+        if (i < ready.size()) {
+            // the rest waits for the next frame, ahead of anything decoded since
+            std::lock_guard<std::mutex> lock(doneMutex);
+            done.insert(done.begin(), ready.begin() + i, ready.end());
+        }
+
+        if (frame % kStaleFrames == 0) {
+            for (auto it = entries.begin(); it != entries.end();) {
+                bool stale = it->second.lastUse + kStaleFrames < frame;
+                if (stale && it->second.status == QUEUED) {
+                    it->second.cancelled->store(true);
+                    --queued;
+                    it = entries.erase(it);
+                } else if (stale && it->second.status == MISSING) {
+                    it = entries.erase(it); // asked again (and re-checked on disk) if it scrolls back
+                } else ++it;
+            }
+        }
+    }
+
+    void Shutdown() {
+        for (auto &kv : entries) if (kv.second.cancelled) kv.second.cancelled->store(true);
+        decoders.reset(); // joins after the remaining (now cancelled) jobs
+        for (auto &d : done) if (d.ok) UnloadImage(d.image);
+        done.clear();
+        for (auto &page : pages) gBackend->UnloadTexture(page);
+        pages.clear();
+        freeSlots.clear();
+        entries.clear();
+        lru.clear();
+        memoryUsed = 0; queued = 0;
+    }
+};
+ThumbnailCache gThumbnails;
+
+// Draws a product's thumbnail centered in box, a placeholder while it loads, nothing without one
+static void DrawThumbnail(const std::string &productName, const Rectangle &box, Color placeholder) {
+    bool loading = false;
+    const AtlasSprite *sprite = gThumbnails.Get(productName, &loading);
+    if (sprite) {
+        float scale = std::min(box.width / sprite->source.width, box.height / sprite->source.height);
+        float w = sprite->source.width * scale, h = sprite->source.height * scale;
+        DrawSprite(*sprite, Rectangle{ box.x + (box.width - w) / 2.0f, box.y + (box.height - h) / 2.0f, w, h }, WHITE);
+    } else if (loading) {
+        gBackend->DrawRectangleRec(box, placeholder);
+    }
 }
 
-bool DrawButton(const Rectangle &r, const Texture2D &icon, Color baseColor, const ColorScheme &colors) {
-    Vector2 mouse = GetMousePosition();
-    bool hovered = CheckCollisionPointRec(mouse, r);
+// Per-screen layouts: rectangles derived from the window size. Each one is rebuilt only when
+// its generation falls behind the app's layout generation (resize, window mode, font scale).
+struct LoginLayout {
+    unsigned generation = 0;
+    Rectangle usernameRect{}, passwordRect{}, showPassBtn{}, forgotBtn{}, registerBtn{};
+    int titleX = 0, titleY = 0, labelX = 0, rowY = 0, passwordRowY = 0;
+    int forgotTextX = 0, forgotTextY = 0, failedX = 0, failedY = 0;
+};
+struct ForgotLayout {
+    unsigned generation = 0;
+    Rectangle userRect{}, sendBtn{}, fieldRect{}, confirmBtn{};
+    int titleX = 0, titleY = 0, introX = 0, introY = 0, sendingX = 0;
+    int codePromptX = 0, passPromptX = 0, promptY = 0, errorY = 0;
+};
+struct RegisterLayout {
+    unsigned generation = 0;
+    Rectangle usernameRect{}, passwordRect{}, confirmRect{}, showPassBtn{}, backBtn{}, homeBtn{}, registerBtn{};
+    int titleX = 0, titleY = 0, hintX = 0, hintY = 0, labelX = 0, usernameY = 0, passwordY = 0;
+    int confirmX = 0, confirmY = 0, messageY = 0;
+};
+struct MenuLayout {
+    unsigned generation = 0;
+    Rectangle logoutBtn{}, optionsBtn{}, btnView{}, btnCart{}, btnAdd{}, btnManage{};
+    float menuSpacing = 0, userInfoY = 0;
+    int pepkaX = 0, pepkaY = 0;
+    Vector2 logoPos{};
+};
+// View-type and category choosers share one grid of big buttons plus back/home
+struct ChooserLayout {
+    unsigned generation = 0;
+    Rectangle topLeft{}, topRight{}, bottomLeft{}, bottomRight{}, bottomCenter{};
+    Rectangle backBtn{}, homeBtn{};
+    float titleY = 0, noteY = 0;
+};
+struct ProductListLayout {
+    unsigned generation = 0;
+    Rectangle backBtn{}, homeBtn{}, searchRect{}, minPriceRect{}, maxPriceRect{};
+    Rectangle sortPriceBtn{}, sortSizeBtn{}, sortChainBtn{};
+    int titleX = 0, titleY = 0, labelX = 0, searchLabelY = 0, priceLabelY = 0, dashX = 0;
+    float chipX = 0, chipY = 0, chipH = 0, chipPad = 0, chipGap = 0, chipMaxX = 0, noSizeMaxX = 0;
+    int facetX = 0, priceFacetY = 0;
+    float wheelStep = 0, keyStep = 0, rowH = 0, startY = 0, listTop = 0, listBottom = 0;
+    float thumbX = 0, thumbSize = 0, nameX = 0, priceX = 0, saleGap = 0, sizeX = 0, viewBtnX = 0, viewBtnW = 0;
+    int noProductsX = 0, noProductsY = 0, noMatchX = 0, noMatchY = 0;
+    Rectangle modal{}, closeBtn{}, addCartBtn{}, modalThumb{};
+};
+struct AddProductLayout {
+    unsigned generation = 0;
+    Rectangle backBtn{}, homeBtn{}, editProductsBtn{}, btnToLogin{};
+    Rectangle nameRect{}, priceRect{}, saleRect{}, sizeAreaRect{}, typeBtns[3]{}, catBtns[4]{}, sizeBtns[6]{};
+    Rectangle btnSave{}, btnCancel{};
+    float labelX = 0;
+    int titleX = 0, titleY = 0, adminNoteX = 0, adminNoteY = 0, loginNoteX = 0, loginNoteY = 0, msgY = 0;
+};
+struct EditProductLayout {
+    unsigned generation = 0;
+    Rectangle backBtn{}, nameRect{}, priceRect{}, saleRect{}, sizeAreaRect{}, descRect{}, catBtns[4]{}, sizeBtns[6]{};
+    Rectangle btnUpdate{}, btnDelete{}, btnCancel{};
+    float labelX = 0;
+    int titleX = 0, titleY = 0;
+};
+struct CartLayout {
+    unsigned generation = 0;
+    Rectangle backBtn{}, homeBtn{}, headerRect{}, totBox{}, checkoutBtn{}, clearBtn{};
+    float listX = 0, listY = 0, cardW = 0, colNameW = 0, colQtyW = 0, colPriceW = 0, rowH = 0, gap = 0;
+    float saleGap = 0, remBtnGap = 0, remBtnW = 0;
+    int loginNoteX = 0, loginNoteY = 0, emptyX = 0, emptyY = 0, emptyHintX = 0, emptyHintY = 0, titleX = 0, titleY = 0;
+};
+struct AdminSearchLayout {
+    unsigned generation = 0;
+    Rectangle box{};
+    int labelX = 0, labelY = 0, countX = 0, countY = 0;
+};
+struct EditProductsLayout {
+    unsigned generation = 0;
+    Rectangle backBtn{}, btnAdd{};
+    float listTop = 0, listBottom = 0, rowH = 0, keyStep = 0, actionBtnW = 0, actionBtnH = 0, editBtnX = 0, removeBtnX = 0;
+    float minThumbH = 0, barX = 0, barW = 0;
+    int titleX = 0, titleY = 0, messageX = 0, messageY = 0, labelX = 0, noMatchX = 0, noMatchY = 0;
+};
+struct UsersLayout {
+    unsigned generation = 0;
+    Rectangle backBtn{}, modal{}, passRect{}, adminChk{}, saveBtn{}, cancelBtn{};
+    float startY = 0, visibleH = 0, rowH = 0, wheelStep = 0, keyStep = 0, actionBtnW = 0, actionBtnH = 0, editBtnX = 0, removeBtnX = 0;
+    int titleX = 0, titleY = 0, noMatchX = 0, noMatchY = 0, labelX = 0, msgY = 0;
+};
+struct ResetModalLayout {
+    unsigned generation = 0;
+    Rectangle modal{}, fieldRects[3]{}, okBtn{}, cancelBtn{};
+    int errorY = 0;
+};
+struct OptionsLayout {
+    unsigned generation = 0;
+    Rectangle backBtn{}, themeDark{}, themeLight{}, winBtn{}, winFsBtn{}, fsBtn{};
+    Rectangle fpsBtns[3]{}, saverBtn{}, resetBtn{};
+    int titleX = 0, titleY = 0, themeLabelX = 0, themeLabelY = 0, winLabelX = 0, winLabelY = 0, fpsLabelX = 0, fpsLabelY = 0;
+};
+
+bool DrawButton(const Rectangle &r, const AtlasSprite &icon, Color baseColor, const ColorScheme &colors) {
+    Vector2 mouse = gBackend->GetMousePosition();
+    bool hovered = gLayerPass != LAYER_STATIC && CheckCollisionPointRec(mouse, r);
+    if (gLayerPass == LAYER_OVERLAY && !hovered) return false;
     Color color = hovered ? Fade(baseColor, 0.8f) : baseColor;
 
-    DrawRectangleRec(r, color);
-    DrawRectangleLinesEx(r, 2, colors.primary);
+    gBackend->DrawRectangleRec(r, color);
+    gBackend->DrawRectangleLinesEx(r, 2, colors.primary);
 
     // Calculate scaling to fit icon within button while maintaining aspect ratio
-    float scale = fmin(r.width / icon.width, r.height / icon.height) * 0.7f;
-    DrawTextureEx(icon, 
-        { r.x + (r.width - icon.width * scale)/2, r.y + (r.height - icon.height * scale)/2 },
-        0.0f, scale, WHITE);
+    if (icon.source.width > 0 && icon.source.height > 0) {
+        float scale = fmin(r.width / icon.source.width, r.height / icon.source.height) * 0.7f;
+        float w = icon.source.width * scale, h = icon.source.height * scale;
+        DrawSprite(icon, Rectangle{ r.x + (r.width - w)/2, r.y + (r.height - h)/2, w, h }, WHITE);
+    }
 
-    if (hovered && IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) return true;
+    if (hovered && gBackend->IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) return true;
     return false;
 }
 
 bool DrawButton(const Rectangle &r, const char *text, Color baseColor, const ColorScheme &colors, int fontSize = 20) {
-    Vector2 mouse = GetMousePosition();
-    bool hovered = CheckCollisionPointRec(mouse, r);
+    Vector2 mouse = gBackend->GetMousePosition();
+    bool hovered = gLayerPass != LAYER_STATIC && CheckCollisionPointRec(mouse, r);
+    if (gLayerPass == LAYER_OVERLAY && !hovered) return false;
     Color color = hovered ? Fade(baseColor, 0.8f) : baseColor;
 
-    DrawRectangleRec(r, color);
-    DrawRectangleLinesEx(r, 2, colors.primary);
+    gBackend->DrawRectangleRec(r, color);
+    gBackend->DrawRectangleLinesEx(r, 2, colors.primary);
 
     // Use the global TTF font via the scaled helpers so the button text uses Calibri
     int textWidth = MeasureTextScaled(text, fontSize);
     int textHeight = ScaledFontSize(fontSize);
+    LayerPass pass = gLayerPass;
+    gLayerPass = LAYER_DIRECT; // a hovered button is redrawn in full over the layer
     DrawTextScaled(text, (int)(r.x + (r.width - textWidth) / 2), (int)(r.y + (r.height - textHeight) / 2), fontSize, colors.text);
+    gLayerPass = pass;
 
-    if (hovered && IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) return true;
+    if (hovered && gBackend->IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) return true;
     return false;
 }
 
-int main() {
+static const char *kStateNames[] = { "Login", "Register", "Forgot password", "Menu", "View type", "Catalog", "Sub catalog",
+                                     "Product list", "Cart", "Add product", "Edit products", "Edit product", "User management", "Options", "Exit" };
+
+// F3 overlay: frame-time graph (last 240 frames, 16.7/33.3 ms guides), percentiles, section times
+// of the last frame and the draw statistics of the last frame
+static void DrawProfilerOverlay(AppState state, const ColorScheme &colors) {
+    const Profiler &prof = gProfiler;
+    float panelW = 360.0f, panelH = 300.0f;
+    float x0 = (float)gBackend->GetScreenWidth() - panelW - 10.0f, y0 = 10.0f;
+    gBackend->DrawRectangleRec(Rectangle{ x0, y0, panelW, panelH }, Fade(BLACK, 0.75f));
+    gBackend->DrawRectangleLinesEx(Rectangle{ x0, y0, panelW, panelH }, 1, colors.accent);
+
+    // Graph: one bar per frame, oldest on the left; full height is 50 ms
+    float gx = x0 + 10.0f, gy = y0 + 10.0f, gw = panelW - 20.0f, gh = 80.0f;
+    float barW = gw / Profiler::kHistory;
+    for (int i = 0; i < prof.historyCount; ++i) {
+        int idx = (prof.historyPos - prof.historyCount + i + Profiler::kHistory) % Profiler::kHistory;
+        float ms = prof.frameMs[idx];
+        float h = std::min(gh, ms / 50.0f * gh);
+        Color c = ms > 33.4f ? RED : (ms > 16.8f ? ORANGE : GREEN);
+        gBackend->DrawRectangleRec(Rectangle{ gx + i * barW, gy + gh - h, std::max(1.0f, barW), h }, c);
+    }
+    gBackend->DrawRectangleRec(Rectangle{ gx, gy + gh - 16.7f / 50.0f * gh, gw, 1.0f }, Fade(WHITE, 0.5f));
+    gBackend->DrawRectangleRec(Rectangle{ gx, gy + gh - 33.3f / 50.0f * gh, gw, 1.0f }, Fade(WHITE, 0.5f));
+
+    // Fixed pixel sizes: the overlay should stay readable regardless of window size
+    char line[128];
+    float ty = gy + gh + 8.0f;
+    auto text = [&](const char *t, Color c) {
+        gBackend->DrawTextEx(gFonts.ForText(14, t, true), t, Vector2{ gx, ty }, 14.0f, 1.4f, c);
+        ty += 17.0f;
+    };
+    snprintf(line, sizeof(line), "%s   frame p50 %.2f  p99 %.2f ms", kStateNames[state],
+             prof.Percentile(prof.frameMs, 0.5f), prof.Percentile(prof.frameMs, 0.99f));
+    text(line, WHITE);
+    snprintf(line, sizeof(line), "cpu p50 %.2f  p99 %.2f ms", prof.Percentile(prof.cpuMs, 0.5f), prof.Percentile(prof.cpuMs, 0.99f));
+    text(line, WHITE);
+    for (int i = 0; i < PROF_COUNT; ++i) {
+        snprintf(line, sizeof(line), "%-20s %7.3f ms", kProfileSectionNames[i], prof.lastSectionTime[i] * 1000.0);
+        text(line, LIGHTGRAY);
+    }
+    snprintf(line, sizeof(line), "draw calls %u  vertices %u  tex switches %u",
+             gDrawStats.frameDrawCalls, gDrawStats.frameVertices, gDrawStats.frameTextureSwitches);
+    text(line, LIGHTGRAY);
+    snprintf(line, sizeof(line), "text measures %u  glyph walks %u", gTextMeasure.calls, gTextMeasure.glyphWalks);
+    text(line, LIGHTGRAY);
+}
+
+int main(int argc, char **argv) {
+    // --bench-text: log per-frame text measurement counters, alternating cache off/on every 2 seconds
+    // --bench-draw: log per-frame draw calls, vertices and texture switches every 2 seconds
+    // --headless <script>: run without a window on the null backend, driven by a script (see RunScriptFrame)
+    bool benchText = false, benchDraw = false;
+    std::string headlessScript;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--bench-text") == 0) benchText = true;
+        if (strcmp(argv[i], "--bench-draw") == 0) benchDraw = true;
+        if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc) headlessScript = argv[++i];
+    }
+    bool headless = !headlessScript.empty();
+    NullBackend nullBackend;
+    if (headless) gBackend = &nullBackend;
+
     const int screenWidth = 800;
     const int screenHeight = 600;
 
-    InitWindow(screenWidth, screenHeight, "Pepka");
-    SetTargetFPS(60);
+    gBackend->InitWindow(screenWidth, screenHeight, "Pepka");
+    // Frame pacing (Options): target FPS while active; with power saver on, the loop sleeps in
+    // EndDrawing until the next input event whenever nothing is changing on screen
+    int targetFps = 60;
+    bool powerSaver = true;
+    gBackend->SetTargetFPS(targetFps);
 
-    // Load TTF from assets (args: filename, fontSize, glyphs pointer or NULL, glyphCount)
-    // Use NULL,0 to load the default glyph set; use larger size (64) for better quality
-    gFont = LoadFontEx("assets/Calibri.ttf", 64, NULL, 0);
-    SetTextureFilter(gFont.texture, TEXTURE_FILTER_BILINEAR);
+    if (!headless) gDrawStats.Init(); // reads rlgl's batch, which only exists with a GPU context
+
+    // TTF from assets; each pixel size is rasterized (or loaded from its cached atlas) on first use
+    gFonts.Init("assets/Calibri.ttf");
+    gTextMeasure.Clear();
+    gThumbnails.Init("data/images"); // thumbnails are optional: disabled when the folder is missing
 
     // Window mode handling: support Windowed, Windowed-Fullscreen (bordered window resized to monitor),
     // and Fullscreen (real fullscreen). Use ApplyWindowMode(...) to change modes.
@@ -174,30 +2355,49 @@ int main() {
     // Start in windowed-fullscreen by default so the app fills the screen but remains a window (bordered)
     WindowMode currentWindowMode = WM_WINDOWED_FULLSCREEN;
 
+    // Screen layouts are rebuilt when this moves: on resize, font scale change or window mode switch
+    unsigned layoutGeneration = 1;
+    int layoutW = 0, layoutH = 0, layoutFontPx = 0;
+    LoginLayout loginLayout;
+    ForgotLayout forgotLayout;
+    RegisterLayout registerLayout;
+    MenuLayout menuLayout;
+    ChooserLayout chooserLayout;
+    ProductListLayout listLayout;
+    AddProductLayout addProductLayout;
+    EditProductLayout editProductLayout;
+    CartLayout cartLayout;
+    AdminSearchLayout adminSearchLayout;
+    EditProductsLayout editProductsLayout;
+    UsersLayout usersLayout;
+    OptionsLayout optionsLayout;
+    ResetModalLayout resetModalLayout;
+
     auto ApplyWindowMode = [&](WindowMode mode) {
-        int mw = GetMonitorWidth(0);
-        int mh = GetMonitorHeight(0);
-        bool isFs = IsWindowFullscreen();
+        int mw = gBackend->GetMonitorWidth(0);
+        int mh = gBackend->GetMonitorHeight(0);
+        bool isFs = gBackend->IsWindowFullscreen();
 
         if (mode == WM_FULLSCREEN) {
             if (!isFs) {
-                ToggleFullscreen(); // switch to fullscreen mode
+                gBackend->ToggleFullscreen(); // switch to fullscreen mode
             }
             // Ensure fullscreen size matches monitor to avoid canvas scaling issues
-            SetWindowSize(mw, mh);
-            SetWindowPosition(0, 0);
+            gBackend->SetWindowSize(mw, mh);
+            gBackend->SetWindowPosition(0, 0);
         } else if (mode == WM_WINDOWED_FULLSCREEN) {
             // Make sure we're not in exclusive fullscreen
-            if (isFs) ToggleFullscreen();
+            if (isFs) gBackend->ToggleFullscreen();
             // Resize window to cover the monitor (bordered window)
-            SetWindowSize(mw, mh);
-            SetWindowPosition(0, 0);
+            gBackend->SetWindowSize(mw, mh);
+            gBackend->SetWindowPosition(0, 0);
         } else { // WM_WINDOWED
-            if (isFs) ToggleFullscreen();
-            SetWindowSize(screenWidth, screenHeight);
-            SetWindowPosition((mw - screenWidth) / 2, (mh - screenHeight) / 2);
+            if (isFs) gBackend->ToggleFullscreen();
+            gBackend->SetWindowSize(screenWidth, screenHeight);
+            gBackend->SetWindowPosition((mw - screenWidth) / 2, (mh - screenHeight) / 2);
         }
         currentWindowMode = mode;
+        ++layoutGeneration; // the new size may only be reported next frame; rebuild anyway
     };
 
     // Apply initial windowed mode (ensures consistent start state)
@@ -229,8 +2429,8 @@ int main() {
     ColorScheme colors = GetColorScheme(currentTheme);
     
     // Login variables
-    char username[32] = "";
-    char password[32] = "";
+    TextField username(31), password(31);
+    password.masked = true;
     // start with no field focused; user must click a box to type
     int inputFocus = -1;
     bool showPassword = false;
@@ -248,248 +2448,322 @@ int main() {
     std::string regMessage = "";
 
     // Products storage
-    struct Product { std::string name; double price; bool hasPrice; double salePercent; bool hasSale; std::string size; std::string fabric; std::string sex; std::string description; int fileIndex; };
-    std::vector<Product> products;
-    std::vector<Product> filteredProducts; // For search/sort results
+    std::vector<CatalogEntry> products;
+    std::vector<int> nameOrder; // product indices in (name, index) order, built on load
+    std::vector<int> filteredIndices; // For search/sort results (indices into products)
+    std::unique_ptr<ThreadPool> workerPool; // created on first use by the large-catalog path
+    unsigned catalogVersion = 0; // bumped on every LoadProducts
+    CatalogPages catalogPages; // list rows and text columns, paged from the catalog file
+    unsigned viewVersion = 0; // bumped whenever filteredIndices changes; keys the catalog pages
+    // Wrapped description lines for the View modal, valid for one (product, width, font size)
+    struct DescriptionLayout { int productIndex = -1; unsigned version = 0; int maxWidth = 0; int fontPx = 0; std::vector<std::string> lines; };
+    DescriptionLayout descLayout;
+    // Preformatted facet strings for the list toolbar, rebuilt whenever facets change
+    std::vector<std::string> sizeChipLabels;
+    std::string noSizeLabel;
+    std::string priceFacetLine;
+    unsigned facetsVersion = 0; // bumped whenever facets are replaced
+    QueryCache queryCache;
+    int productNameBits = 1, productSizeBits = 1; // key widths for PackSortKey
+    std::vector<std::string> sizeLabels; // distinct sizes, indexed by Product::sizeOrd
+    int selectedSizeOrd = -1; // size filter (-1 = any)
+    SizeTaxonomy sizeTaxonomy;
+    {
+        std::ifstream sizesFile("data/sizes.txt");
+        std::stringstream sizesText;
+        if (sizesFile) sizesText << sizesFile.rdbuf();
+        sizeTaxonomy.Parse(sizesFile ? sizesText.str() : std::string(kDefaultSizeTaxonomy));
+    }
+    // Catalog indexes rebuilt on load: priced products sorted by effective price (for range
+    // queries) and one bitmap per category / product group
+    std::vector<int> priceIndex;
+    std::vector<double> priceIndexKeys;
+    Bitmap categoryBits[5];
+    Bitmap groupBits[4];
+    FacetCounts facets;
     bool productsLoaded = false;
-    float productsScroll = 0.0f;
+    double productsScroll = 0.0; // double: 10M rows put the offset near 4e8 px, past float's pixel precision
+    std::string productsPath = "data/products.txt"; // headless benchmarks swap in a generated catalog
     
     // Search and sort variables
-    char searchInput[64] = "";
+    TextField searchInput(63);
     bool searchActive = false;
-    int sortMode = 0; // 0=default, 1=price asc, 2=price desc, 3=size asc, 4=size desc
+    char minPriceInput[16] = ""; // empty = no bound
+    char maxPriceInput[16] = "";
+    int priceInputFocus = 0; // 0=none, 1=min, 2=max
+    int sortMode = 0; // index into sortChains: 0=default, 1=price asc, 2=price desc, 3=size asc, 4=size desc, 5+=chains
+    std::vector<SortChain> sortChains = DefaultSortChains();
+    LoadSortChains("data/sort_chains.txt", sortChains);
     bool needsResort = true;
     int selectedCategory = 0; // 0=All,1=Criança,2=Homem,3=Mulher,4=Bebê
     int selectedProductGroup = 0; // 0=All/none,1=Clothes,2=Accessories,3=Shoes
     int editProductIndex = -1; // used by Edit Products screens
+    Product editProductRecord; // the edited product's full catalog line, read when Edit is clicked
     bool editProductPopulateNeeded = false;
+    // Edit Products admin list: products matching the admin search in name order (nameOrder
+    // itself for an empty search), rebuilt only when the catalog or the search changes; row
+    // labels are formatted for the visible window only
+    TextField editSearchInput(63);
+    bool editSearchActive = false;
+    double editListScroll = 0.0; // double, like productsScroll
+    std::vector<int> editListIndices;
+    std::string editListMessage; // why the last Edit/Remove could not run
+    unsigned editListCatalogVersion = ~0u;
+    std::string editListQuery;
+    std::vector<TextLabel> editRowLabels; // "name - $price" for rows [editRowLabelsFirst, +size)
+    size_t editRowLabelsFirst = 0;
+    unsigned editRowLabelsVersion = ~0u;
+    unsigned editListVersion = 0;
 
     auto LoadProducts = [&](const std::string &path) -> bool {
+        ProfileScope prof(PROF_LOAD);
         products.clear();
-        std::ifstream ifs(path);
+        nameOrder.clear();
+        filteredIndices.clear();
+        ++viewVersion;
+        needsResort = true;
+        ++catalogVersion;
+        queryCache.Clear();
+        catalogPages.Open(path);
+        // Binary mode so the offsets written to the index are real byte positions
+        std::ifstream ifs(path, std::ios::binary);
         if (!ifs) return false;
+        std::ofstream idx(CatalogPages::IndexPathFor(path), std::ios::binary | std::ios::trunc);
+        // Names and sizes are held only during the load, to rank them and write the names file
+        std::vector<std::string> names, sizes;
         std::string line;
         int lineIndex = 0;
+        uint64_t offset = 0;
         while (std::getline(ifs, line)) {
+            uint64_t lineStart = offset;
+            offset += line.size() + 1;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
             if (line.empty()) continue;
-            // Split by ';' into tokens: name;price;size;description (description optional, may contain semicolons)
-            std::vector<std::string> tokens;
-            size_t start = 0;
-            while (true) {
-                size_t p = line.find(';', start);
-                if (p == std::string::npos) {
-                    tokens.push_back(line.substr(start));
-                    break;
-                }
-                tokens.push_back(line.substr(start, p - start));
-                start = p + 1;
-            }
-            std::string name = tokens.size() > 0 ? tokens[0] : std::string();
-            std::string priceStr = tokens.size() > 1 ? tokens[1] : std::string();
-            std::string sizeStr = tokens.size() > 2 ? tokens[2] : std::string();
-            std::string fabricStr;
-            std::string sexStr;
-            std::string descStr;
-            double salePercent = 0.0;
-            bool hasSale = false;
-            // Support both old and new formats. Preferred new format:
-            // name;price;size;fabric;sex;description (description may contain ';')
-            if (tokens.size() >= 7) {
-                fabricStr = tokens[3];
-                sexStr = tokens[4];
-                std::string saleStr = tokens[5];
-                descStr = tokens[6];
-                for (size_t i = 7; i < tokens.size(); ++i) descStr += ";" + tokens[i];
-                try { salePercent = std::stod(saleStr); hasSale = true; } catch(...) { hasSale = false; salePercent = 0.0; }
-            } else if (tokens.size() == 6) {
-                // ambiguous: token[5] might be sale or description. Detect numeric -> sale, otherwise description
-                fabricStr = tokens[3];
-                sexStr = tokens[4];
-                std::string t5 = tokens[5];
-                bool looksNumeric = !t5.empty();
-                for (char c : t5) if (!(isdigit((unsigned char)c) || c=='.' || c=='-' )) { looksNumeric = false; break; }
-                if (looksNumeric) {
-                    try { salePercent = std::stod(t5); hasSale = true; } catch(...) { hasSale = false; salePercent = 0.0; }
-                    descStr.clear();
-                } else {
-                    descStr = t5;
-                }
-            } else if (tokens.size() == 5) {
-                // name;price;size;fabric;description  (no sex provided)
-                fabricStr = tokens[3];
-                descStr = tokens[4];
-            } else if (tokens.size() == 4) {
-                // older format: name;price;size;description
-                descStr = tokens[3];
-            }
-
-            double price = 0.0;
-            bool ok = false;
-            if (!priceStr.empty()) {
-                try {
-                    size_t s = 0;
-                    while (s < priceStr.size() && !((priceStr[s] >= '0' && priceStr[s] <= '9') || priceStr[s] == '.' || priceStr[s] == '-')) s++;
-                    std::string trimmed = priceStr.substr(s);
-                    price = std::stod(trimmed);
-                    ok = true;
-                } catch (...) { ok = false; }
-            }
-            products.push_back({ name, price, ok, salePercent, hasSale, sizeStr, fabricStr, sexStr, descStr, lineIndex });
+            idx.write((const char *)&lineStart, sizeof(lineStart));
+            Product parsed = ParseProductLine(line, lineIndex);
+            products.push_back(MakeCatalogEntry(parsed));
+            names.push_back(std::move(parsed.name));
+            sizes.push_back(std::move(parsed.size));
             ++lineIndex;
         }
+        idx.close();
+        // Rows, descriptions and the edit form are read back through the index: without a
+        // complete one the catalog is not usable
+        if (!idx) { std::cout << "Cannot write " << CatalogPages::IndexPathFor(path) << std::endl; products.clear(); return false; }
 
         // Sort products: priced items first (ascending by price), then unpriced items
-        std::sort(products.begin(), products.end(), [](const Product &a, const Product &b) {
-            if (a.hasPrice != b.hasPrice) return a.hasPrice; // true before false
-            if (!a.hasPrice && !b.hasPrice) return a.name < b.name;
-            return a.price < b.price;
-        });
+        {
+            std::vector<int> perm(products.size());
+            for (size_t i = 0; i < perm.size(); ++i) perm[i] = (int)i;
+            std::sort(perm.begin(), perm.end(), [&](int a, int b) {
+                const CatalogEntry &pa = products[a], &pb = products[b];
+                if (pa.hasPrice != pb.hasPrice) return pa.hasPrice; // true before false
+                if (!pa.hasPrice && !pb.hasPrice) return names[a] < names[b];
+                return pa.price < pb.price;
+            });
+            std::vector<CatalogEntry> sortedProducts(products.size());
+            std::vector<std::string> sortedNames(names.size()), sortedSizes(sizes.size());
+            for (size_t k = 0; k < perm.size(); ++k) {
+                sortedProducts[k] = products[perm[k]];
+                sortedNames[k].swap(names[perm[k]]);
+                sortedSizes[k].swap(sizes[perm[k]]);
+            }
+            products.swap(sortedProducts); names.swap(sortedNames); sizes.swap(sortedSizes);
+        }
+
+        sizeLabels = RankProducts(products, names, sizes, sizeTaxonomy, nameOrder);
+        selectedSizeOrd = -1; // ordinals change on reload
+        uint32_t maxName = 0, maxSize = 0;
+        for (const auto &p : products) { maxName = std::max(maxName, p.nameRank); maxSize = std::max(maxSize, p.sizeOrd); }
+        productNameBits = BitsFor(maxName);
+        productSizeBits = BitsFor(maxSize);
+
+        // Lowercase names in product order for name searches (see CatalogPages::MatchNames)
+        std::ofstream namesOut(CatalogPages::NamesPathFor(path), std::ios::binary | std::ios::trunc);
+        for (auto &n : names) {
+            std::transform(n.begin(), n.end(), n.begin(), ::tolower);
+            namesOut.write(n.data(), (std::streamsize)n.size());
+            namesOut.put('\n');
+        }
+        namesOut.close();
+        if (!namesOut) { std::cout << "Cannot write " << CatalogPages::NamesPathFor(path) << std::endl; products.clear(); nameOrder.clear(); return false; }
+
+        priceIndex.clear();
+        for (size_t i = 0; i < products.size(); ++i) if (products[i].hasPrice) priceIndex.push_back((int)i);
+        std::sort(priceIndex.begin(), priceIndex.end(), [&](int a, int b) { return EffectivePrice(products[a]) < EffectivePrice(products[b]); });
+        priceIndexKeys.resize(priceIndex.size());
+        for (size_t k = 0; k < priceIndex.size(); ++k) priceIndexKeys[k] = EffectivePrice(products[priceIndex[k]]);
+        for (int c = 1; c <= 4; ++c) categoryBits[c].Reset(products.size());
+        for (int g = 2; g <= 3; ++g) groupBits[g].Reset(products.size());
+        for (size_t i = 0; i < products.size(); ++i) {
+            for (int c = 1; c <= 4; ++c) if (products[i].catMask & (1u << c)) categoryBits[c].Set(i);
+            for (int g = 2; g <= 3; ++g) if (products[i].groupMask & (1u << g)) groupBits[g].Set(i);
+        }
 
         return true;
     };
+
+    // Products whose name contains a lowercase term, as a bitmap over product indices. The names
+    // file is streamed once per distinct term and catalog load; the last result is kept.
+    Bitmap nameMatches;
+    std::string nameMatchesTerm;
+    unsigned nameMatchesVersion = ~0u;
+    auto NameMatches = [&](const std::string &term) -> const Bitmap & {
+        if (nameMatchesVersion != catalogVersion || nameMatchesTerm != term) {
+            catalogPages.MatchNames(term, products.size(), nameMatches);
+            nameMatchesTerm = term;
+            nameMatchesVersion = catalogVersion;
+        }
+        return nameMatches;
+    };
+    // Index of the first product named exactly `name`, or -1: a binary search of nameOrder that
+    // reads the probed names from the catalog file
+    auto FindProductByName = [&](const std::string &name) -> int {
+        Product probe;
+        size_t lo = 0, hi = nameOrder.size();
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (!catalogPages.ReadProduct(products[nameOrder[mid]].fileIndex, probe)) return -1;
+            if (probe.name < name) lo = mid + 1; else hi = mid;
+        }
+        if (lo == nameOrder.size() || !catalogPages.ReadProduct(products[nameOrder[lo]].fileIndex, probe) || probe.name != name) return -1;
+        return nameOrder[lo];
+    };
     
+    auto BuildFacetLabels = [&]() {
+        ++facetsVersion;
+        sizeChipLabels.resize(facets.size.size());
+        for (size_t si = 0; si < facets.size.size(); ++si)
+            sizeChipLabels[si] = sizeLabels[si] + " (" + std::to_string(facets.size[si]) + ")";
+        noSizeLabel = "none (" + std::to_string(facets.noSize) + ")";
+        priceFacetLine = "Price:";
+        for (int b = 0; b < 5; ++b)
+            if (b < 4 || facets.price[b] > 0) priceFacetLine += std::string("  ") + kPriceBucketLabels[b] + " (" + std::to_string(facets.price[b]) + ")";
+    };
+
     auto FilterAndSortProducts = [&]() {
-        // Start with all products
-        filteredProducts.clear();
-        std::string searchTerm = searchInput;
+        ProfileScope prof(PROF_FILTER);
+        std::string searchTerm = searchInput.Text();
         std::transform(searchTerm.begin(), searchTerm.end(), searchTerm.begin(), ::tolower);
-        // helper: case-insensitive contains
-        auto ciContains = [](const std::string &hay, const std::string &needle)->bool {
-                std::string h = hay; std::string n = needle;
-                std::transform(h.begin(), h.end(), h.begin(), ::tolower);
-                std::transform(n.begin(), n.end(), n.begin(), ::tolower);
-                return h.find(n) != std::string::npos;
-        };
 
-        // Size ranking helper: XXS, XS, S, M, L, XL, XXL (unknown sizes fall back to lexicographic but rank after known ones)
-        auto sizeRank = [](const std::string &s)->int {
-            std::string t = s;
-            std::transform(t.begin(), t.end(), t.begin(), ::tolower);
-            if (t == "xxs") return 0;
-            if (t == "xs")  return 1;
-            if (t == "s")   return 2;
-            if (t == "m")   return 3;
-            if (t == "l")   return 4;
-            if (t == "xl")  return 5;
-            if (t == "xxl" || t == "2xl") return 6;
-            // Unknown sizes: put them after known sizes but keep a deterministic ordering
-            int h = 100;
-            for (char c : t) h = h * 31 + (int)c;
-            return h;
-        };
+        // Views already computed for this exact filter state come straight from the cache
+        std::string queryKey = std::to_string(catalogVersion) + "|" + std::to_string(selectedCategory) + "|" +
+            std::to_string(selectedProductGroup) + "|" + std::to_string(sortMode) + "|" + std::to_string(selectedSizeOrd) + "|" +
+            minPriceInput + "|" + maxPriceInput + "|" + searchTerm;
+        if (const QueryCache::Entry *hit = queryCache.Get(queryKey)) {
+            filteredIndices = hit->indices;
+            ++viewVersion;
+            facets = hit->facets;
+            BuildFacetLabels();
+            needsResort = false;
+            return;
+        }
 
-        // Filter by category then product-group (clothes/accessories/shoes) then search term
-        for (const auto& product : products) {
-            bool categoryMatch = true;
-            if (selectedCategory != 0) {
-                // prefer explicit single-letter codes saved in product.sex (M/W/K/B)
-                std::string sexLower = product.sex;
-                std::transform(sexLower.begin(), sexLower.end(), sexLower.begin(), ::tolower);
-
-                if (selectedCategory == 2) { // Homem
-                    categoryMatch = (sexLower == "m") || ciContains(product.name, "men") || ciContains(product.description, "men");
-                } else if (selectedCategory == 3) { // Mulher
-                    categoryMatch = (sexLower == "w") || ciContains(product.name, "women") || ciContains(product.description, "women") || ciContains(product.name, "mulher") || ciContains(product.description, "mulher");
-                } else if (selectedCategory == 4) { // Bebê
-                    categoryMatch = (sexLower == "b") || ciContains(product.name, "bebe") || ciContains(product.name, "baby") || ciContains(product.description, "baby") || ciContains(product.description, "bebe");
-                } else if (selectedCategory == 1) { // Criança
-                    categoryMatch = (sexLower == "k") || ciContains(product.name, "kid") || ciContains(product.name, "crian") || ciContains(product.description, "kid") || ciContains(product.description, "crian");
-                }
+        // Start with all products
+        filteredIndices.clear();
+        // Optional price range (effective price). When set, only the slice of the sorted price
+        // index between two binary searches is visited instead of the whole catalog.
+        double minPrice = 0.0, maxPrice = 0.0;
+        bool hasMin = false, hasMax = false;
+        if (minPriceInput[0] != '\0') { char *end = nullptr; minPrice = strtod(minPriceInput, &end); hasMin = end != minPriceInput; }
+        if (maxPriceInput[0] != '\0') { char *end = nullptr; maxPrice = strtod(maxPriceInput, &end); hasMax = end != maxPriceInput; }
+        bool priceRange = hasMin || hasMax;
+        size_t rangeLo = 0, rangeHi = priceIndex.size();
+        if (hasMin) rangeLo = std::lower_bound(priceIndexKeys.begin(), priceIndexKeys.end(), minPrice) - priceIndexKeys.begin();
+        if (hasMax) rangeHi = std::upper_bound(priceIndexKeys.begin(), priceIndexKeys.end(), maxPrice) - priceIndexKeys.begin();
+        if (rangeHi < rangeLo) rangeHi = rangeLo;
+
+        // One columnar pass: filter by category, product group and search term, and count facets
+        // for the same search as we go
+        facets = FacetCounts();
+        facets.size.assign(sizeLabels.size(), 0);
+        const Bitmap *catFilter = (selectedCategory >= 1 && selectedCategory <= 4) ? &categoryBits[selectedCategory] : nullptr;
+        const Bitmap *groupFilter = (selectedProductGroup >= 2 && selectedProductGroup <= 3) ? &groupBits[selectedProductGroup] : nullptr;
+        const Bitmap *nameFilter = searchTerm.empty() ? nullptr : &NameMatches(searchTerm);
+        auto visit = [&](size_t pi, FacetCounts &fc, std::vector<int> &out) {
+            const auto &product = products[pi];
+            if (nameFilter && !nameFilter->Test(pi)) return;
+
+            bool groupMatch = !groupFilter || groupFilter->Test(pi);
+            if (groupMatch) {
+                fc.category[0]++;
+                for (int c = 1; c <= 4; ++c) if (product.catMask & (1u << c)) fc.category[c]++;
             }
-            if (!categoryMatch) continue;
-
-            // Product-group filtering (basic keyword-based):
-            bool groupMatch = true;
-            if (selectedProductGroup == 2) { // Accessories
-                // Check for accessory keywords in name or description
-                std::string lname = product.name; std::string ldesc = product.description;
-                std::transform(lname.begin(), lname.end(), lname.begin(), ::tolower);
-                std::transform(ldesc.begin(), ldesc.end(), ldesc.begin(), ::tolower);
-                const char* aks[] = {"accessor", "belt", "hat", "cap", "scarf", "bag", "purse", "sunglass", "earring", "necklace", "watch", "glove", "gloves"};
-                groupMatch = false;
-                for (const char* k : aks) if (lname.find(k) != std::string::npos || ldesc.find(k) != std::string::npos) { groupMatch = true; break; }
-            } else if (selectedProductGroup == 3) { // Shoes
-                std::string lname = product.name; std::string ldesc = product.description;
-                std::transform(lname.begin(), lname.end(), lname.begin(), ::tolower);
-                std::transform(ldesc.begin(), ldesc.end(), ldesc.begin(), ::tolower);
-                const char* sks[] = {"shoe", "sneaker", "boot", "sandals", "trainer", "loafer", "flip", "cleat"};
-                groupMatch = false;
-                for (const char* k : sks) if (lname.find(k) != std::string::npos || ldesc.find(k) != std::string::npos) { groupMatch = true; break; }
-            }
-            if (!groupMatch) continue;
-
-            if (searchTerm.empty()) {
-                filteredProducts.push_back(product);
-            } else {
-                std::string productName = product.name;
-                std::transform(productName.begin(), productName.end(), productName.begin(), ::tolower);
-                if (productName.find(searchTerm) != std::string::npos) {
-                    filteredProducts.push_back(product);
-                }
+            fc.group[1]++;
+            for (int g = 2; g <= 3; ++g) if (product.groupMask & (1u << g)) fc.group[g]++;
+
+            if (!groupMatch || (catFilter && !catFilter->Test(pi))) return;
+            // size counts ignore the size filter itself so the other sizes stay pickable
+            if (!product.hasSize) fc.noSize++;
+            else if (product.sizeOrd < fc.size.size()) fc.size[product.sizeOrd]++;
+            if (selectedSizeOrd >= 0 && (!product.hasSize || (int)product.sizeOrd != selectedSizeOrd)) return;
+            out.push_back((int)pi);
+            fc.price[PriceBucket(product)]++;
+        };
+        size_t candidateCount = priceRange ? rangeHi - rangeLo : products.size();
+        auto candidate = [&](size_t k) -> size_t { return priceRange ? (size_t)priceIndex[rangeLo + k] : k; };
+
+        // Sort filtered products: pack the active chain into one integer key per product,
+        // then sort (key, index) pairs
+        if (sortMode < 0 || sortMode >= (int)sortChains.size()) sortMode = 0;
+        const SortChain &chain = sortChains[sortMode];
+
+        if (candidateCount >= ParallelFilterThreshold() && std::thread::hardware_concurrency() > 1) {
+            // Large catalog: each worker filters and sorts its own slice, then the sorted runs
+            // are merged pairwise (also in parallel)
+            if (!workerPool) workerPool.reset(new ThreadPool(std::thread::hardware_concurrency()));
+            size_t chunks = workerPool->Size();
+            std::vector<FacetCounts> partFacets(chunks);
+            std::vector<std::vector<std::pair<uint64_t, int>>> runs(chunks);
+            workerPool->ParallelFor(chunks, [&](size_t c) {
+                partFacets[c].size.assign(sizeLabels.size(), 0);
+                std::vector<int> local;
+                size_t begin = candidateCount * c / chunks, end = candidateCount * (c + 1) / chunks;
+                for (size_t k = begin; k < end; ++k) visit(candidate(k), partFacets[c], local);
+                runs[c].reserve(local.size());
+                for (int idx : local) runs[c].push_back({ PackSortKey(products[idx], chain, productNameBits, productSizeBits), idx });
+                std::sort(runs[c].begin(), runs[c].end());
+            });
+            for (const auto &pf : partFacets) facets.Add(pf);
+            while (runs.size() > 1) {
+                std::vector<std::vector<std::pair<uint64_t, int>>> merged((runs.size() + 1) / 2);
+                workerPool->ParallelFor(merged.size(), [&](size_t m) {
+                    if (2 * m + 1 >= runs.size()) { merged[m].swap(runs[2 * m]); return; }
+                    const auto &a = runs[2 * m], &b = runs[2 * m + 1];
+                    merged[m].resize(a.size() + b.size());
+                    std::merge(a.begin(), a.end(), b.begin(), b.end(), merged[m].begin());
+                });
+                runs.swap(merged);
             }
+            filteredIndices.resize(runs[0].size());
+            for (size_t k = 0; k < runs[0].size(); ++k) filteredIndices[k] = runs[0][k].second;
+        } else {
+            for (size_t k = 0; k < candidateCount; ++k) visit(candidate(k), facets, filteredIndices);
+            std::vector<std::pair<uint64_t, int>> keyed;
+            keyed.reserve(filteredIndices.size());
+            for (int idx : filteredIndices) keyed.push_back({ PackSortKey(products[idx], chain, productNameBits, productSizeBits), idx });
+            std::sort(keyed.begin(), keyed.end());
+            for (size_t k = 0; k < keyed.size(); ++k) filteredIndices[k] = keyed[k].second;
         }
+        ++viewVersion;
+        queryCache.Put(queryKey, filteredIndices, facets);
+        BuildFacetLabels();
 
-        // Sort filtered products
-        switch (sortMode) {
-            case 1: // Price ascending
-                std::sort(filteredProducts.begin(), filteredProducts.end(), [](const Product &a, const Product &b) {
-                    if (a.hasPrice != b.hasPrice) return a.hasPrice;
-                    if (!a.hasPrice && !b.hasPrice) return a.name < b.name;
-                    double priceA = a.price;
-                    double priceB = b.price;
-                    if (a.hasSale) priceA *= (1.0 - a.salePercent/100.0);
-                    if (b.hasSale) priceB *= (1.0 - b.salePercent/100.0);
-                    return priceA < priceB;
-                });
-                break;
-            case 2: // Price descending
-                std::sort(filteredProducts.begin(), filteredProducts.end(), [](const Product &a, const Product &b) {
-                    if (a.hasPrice != b.hasPrice) return a.hasPrice;
-                    if (!a.hasPrice && !b.hasPrice) return a.name < b.name;
-                    double priceA = a.price;
-                    double priceB = b.price;
-                    if (a.hasSale) priceA *= (1.0 - a.salePercent/100.0);
-                    if (b.hasSale) priceB *= (1.0 - b.salePercent/100.0);
-                    return priceA > priceB;
-                });
-                break;
-            case 3: // Size ascending (use sizeRank for natural ordering)
-                std::sort(filteredProducts.begin(), filteredProducts.end(), [&](const Product &a, const Product &b) {
-                    bool aHas = !a.size.empty();
-                    bool bHas = !b.size.empty();
-                    if (aHas != bHas) return aHas; // items with size first
-                    if (!aHas && !bHas) return a.name < b.name;
-                    int ra = sizeRank(a.size);
-                    int rb = sizeRank(b.size);
-                    if (ra != rb) return ra < rb;
-                    return a.name < b.name;
-                });
-                break;
-            case 4: // Size descending (reverse rank)
-                std::sort(filteredProducts.begin(), filteredProducts.end(), [&](const Product &a, const Product &b) {
-                    bool aHas = !a.size.empty();
-                    bool bHas = !b.size.empty();
-                    if (aHas != bHas) return aHas; // items with size first
-                    if (!aHas && !bHas) return a.name < b.name;
-                    int ra = sizeRank(a.size);
-                    int rb = sizeRank(b.size);
-                    if (ra != rb) return ra > rb;
-                    return a.name < b.name;
-                });
-                break;
-            default: // Default sorting (original logic)
-                std::sort(filteredProducts.begin(), filteredProducts.end(), [](const Product &a, const Product &b) {
-                    if (a.hasPrice != b.hasPrice) return a.hasPrice; // true before false
-                    if (!a.hasPrice && !b.hasPrice) return a.name < b.name;
-                    return a.price < b.price;
-                });
-                break;
-        }
-        
         needsResort = false;
     };
     
+    // Account edits from Manage Accounts only mark the list dirty; the full rewrite of users.txt
+    // happens once the admin pauses, leaves the screen or quits (see FlushUsers)
+    unsigned usersVersion = 0; // bumped when accounts are added
+    bool usersDirty = false;
+    double usersDirtySince = 0.0;
+    auto MarkUsersDirty = [&]() {
+        if (!usersDirty) usersDirtySince = gBackend->GetTime();
+        usersDirty = true;
+    };
+
     auto SaveUser = [&](const std::string &username, const std::string &password) -> bool {
+        ProfileScope prof(PROF_FILE_IO);
         // Check if user already exists (by name)
         for (const auto& user : users) {
             if (user.name == username) {
@@ -505,11 +2779,13 @@ int main() {
 
         // Add to current users list
         users.push_back({username, password, false});
+        ++usersVersion;
         return true;
     };
 
     // Save the full users vector back to users.txt (overwrite)
     auto SaveAllUsers = [&]() -> bool {
+        ProfileScope prof(PROF_FILE_IO);
         std::ofstream ofs("users.txt", std::ios::trunc);
         if (!ofs) return false;
         for (const auto &u : users) {
@@ -518,8 +2794,10 @@ int main() {
             ofs << "\n";
         }
         ofs.close();
+        usersDirty = false;
         return true;
     };
+    auto FlushUsers = [&]() { if (usersDirty) SaveAllUsers(); };
 
     // Per-user cart persistence: file per user at data/cart_<username>.txt
     auto CartFilename = [&](const std::string &user)->std::string {
@@ -528,6 +2806,7 @@ int main() {
     };
 
     auto LoadCart = [&](const std::string &user) {
+        ProfileScope prof(PROF_FILE_IO);
         std::vector<std::pair<std::string,int>> cart;
         if (user.empty()) return cart;
         std::ifstream ifs(CartFilename(user));
@@ -546,7 +2825,11 @@ int main() {
         return cart;
     };
 
+    unsigned cartVersion = 0; // bumped whenever the cart is loaded or saved
+
     auto SaveCart = [&](const std::string &user, const std::vector<std::pair<std::string,int>> &cart)->bool {
+        ProfileScope prof(PROF_FILE_IO);
+        ++cartVersion;
         if (user.empty()) return false;
         std::ofstream ofs(CartFilename(user), std::ios::trunc);
         if (!ofs) return false;
@@ -557,100 +2840,439 @@ int main() {
     // In-memory cart for currently logged user
     std::vector<std::pair<std::string,int>> currentCart;
 
+    // Cart row display strings, rebuilt only when the cart or the catalog changes
+    struct CartRowLabels { int productIndex; TextLabel qty; TextLabel price; TextLabel subtotal; ProductLabels product; };
+    std::vector<CartRowLabels> cartRows;
+    TextLabel cartTotalLabel;
+    unsigned cartRowsCartVersion = ~0u, cartRowsCatalogVersion = ~0u;
+
     // popup notification for actions like Add to Cart
     static std::string cartPopupMsg = "";
     static float cartPopupTimer = 0.0f;
     const float cartPopupDur = 1.5f; // seconds
 
     // Add this near the top of main(), after InitWindow:
-    Texture2D logo = LoadTexture("assets/logo.png");
-    Texture2D homeIcon = LoadTexture("assets/home_ggl.png");
+    // Icons share one atlas texture
+    IconAtlas icons;
+    int logoId = icons.Add("assets/logo.png");
+    int homeIconId = icons.Add("assets/home_ggl.png");
+    icons.Build();
+    AtlasSprite logo = icons.sprites[logoId];
+    AtlasSprite homeIcon = icons.sprites[homeIconId];
+
+    // Cached static layer for MENU / VIEW_TYPE / CATALOG / OPTIONS (see LayerPass)
+    RenderTexture2D staticLayer = {};
+    bool staticLayerValid = false;
+    uint64_t staticLayerKey = 0;
+
+    // Reset Password overlay (opened from OPTIONS): drawn over the screen inside the main loop,
+    // which keeps popups and background work running while it is open
+    struct ResetPasswordModal {
+        bool open = false;
+        int focusIndex = 0; // 0 = old, 1 = new, 2 = confirm
+        std::string oldPass, newPass, confirmPass, error;
+    };
+    ResetPasswordModal resetModal;
+
+    // Idle detection for power saver: frames since the last input or animation
+    int idleFrames = 0;
+    bool eventWaiting = false;
+
+    // Text benchmark accumulators (see --bench-text)
+    int benchFrames = 0;
+    unsigned long benchCalls = 0, benchWalks = 0, benchGlyphs = 0;
+    double benchStart = gBackend->GetTime();
+    int drawBenchFrames = 0;
+    unsigned long drawBenchCalls = 0, drawBenchVertices = 0, drawBenchSwitches = 0;
+    unsigned drawBenchMaxCalls = 0;
+    double drawBenchStart = gBackend->GetTime();
+
+    // --- Headless script runner ---
+    // One command per line, '#' starts a comment. Commands marked * consume frames:
+    //   size W H            virtual screen size in pixels
+    //   catalog N           generate a synthetic N-product catalog and use it instead of data/products.txt
+    //   users N             add N synthetic accounts in memory (saved only if an account is edited)
+    //   login USER          log in as USER without going through the login screen
+    //   goto STATE          login | register | menu | viewtype | catalog | products | cart |
+    //                       editproducts | users | options
+    //   search TEXT         set the product search text
+    //   mouse X Y           move the mouse (fractions of the screen size)
+    //   wheel D             mouse wheel movement applied every frame from now on (0 stops)
+    //   hold KEY / release KEY   keep a key down / let it go (UP, DOWN, LEFT, RIGHT, ENTER, ...)
+    //   text STRING         queue typed characters
+    // * click               press (one frame) and release (next frame) the left mouse button
+    // * key KEY             tap a key for one frame
+    // * frames N            run N frames with the current input
+    struct HeadlessScript {
+        std::vector<std::string> lines;
+        size_t pos = 0;
+        int framesLeft = 0;
+        bool releasePending = false;
+        double lastFrame = -1.0;
+        std::vector<double> frameMs;
+    } script;
+    if (headless) {
+        std::ifstream scriptFile(headlessScript);
+        if (!scriptFile) { std::cout << "[headless] cannot open script " << headlessScript << std::endl; return 1; }
+        std::string line;
+        while (std::getline(scriptFile, line)) script.lines.push_back(line);
+    }
+    auto ScriptKey = [](const std::string &name) -> int {
+        static const std::pair<const char *, int> keys[] = {
+            { "UP", KEY_UP }, { "DOWN", KEY_DOWN }, { "LEFT", KEY_LEFT }, { "RIGHT", KEY_RIGHT }, { "ENTER", KEY_ENTER },
+            { "ESCAPE", KEY_ESCAPE }, { "BACKSPACE", KEY_BACKSPACE }, { "TAB", KEY_TAB }, { "F3", KEY_F3 }, { "F11", KEY_F11 },
+            { "PAGE_UP", KEY_PAGE_UP }, { "PAGE_DOWN", KEY_PAGE_DOWN }, { "HOME", KEY_HOME }, { "END", KEY_END },
+            { "DELETE", KEY_DELETE }, { "SHIFT", KEY_LEFT_SHIFT }, { "CONTROL", KEY_LEFT_CONTROL } };
+        for (const auto &k : keys) if (name == k.first) return k.second;
+        return name.size() == 1 ? toupper((unsigned char)name[0]) : 0;
+    };
+    // Synthetic catalog covering every category, group, size label and about one sale in five
+    auto WriteSyntheticCatalog = [&](int count, const std::string &path) -> bool {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) return false;
+        const char *sexes[] = { "M", "W", "K", "B", "U" };
+        const char *kinds[] = { "Shirt", "Jacket", "Boots", "Sneakers", "Hat", "Belt", "Dress", "Jeans" };
+        for (int i = 0; i < count; ++i) {
+            unsigned h = (unsigned)i * 2654435761u;
+            const std::string &size = sizeTaxonomy.labels[h % sizeTaxonomy.labels.size()];
+            char line[160];
+            snprintf(line, sizeof(line), "%s %06d;%.2f;%s;cotton;%s;%d;Synthetic product %d", kinds[(h >> 8) % 8], i,
+                     1.0 + (h % 20000) / 100.0, size.c_str(), sexes[(h >> 4) % 5], (i % 5 == 0) ? (int)(10 + h % 41) : 0, i);
+            out << line << "\n";
+        }
+        return true;
+    };
+    // Applies script commands up to the next one that consumes a frame; false once the script ends
+    auto RunScriptFrame = [&]() -> bool {
+        double now = gBackend->GetTime();
+        if (script.lastFrame >= 0.0) script.frameMs.push_back((now - script.lastFrame) * 1000.0);
+        script.lastFrame = now;
+        nullBackend.BeginInputFrame();
+        if (script.releasePending) {
+            nullBackend.buttonReleased[0] = true;
+            nullBackend.buttonDown[0] = false;
+            script.releasePending = false;
+            return true;
+        }
+        if (script.framesLeft > 0) { script.framesLeft--; return true; }
+        while (script.pos < script.lines.size()) {
+            std::istringstream in(script.lines[script.pos++]);
+            std::string cmd;
+            if (!(in >> cmd) || cmd[0] == '#') continue;
+            if (cmd == "frames") {
+                int n = 0; in >> n;
+                if (n > 0) { script.framesLeft = n - 1; return true; }
+            } else if (cmd == "click") {
+                nullBackend.buttonPressed[0] = nullBackend.buttonDown[0] = true;
+                script.releasePending = true;
+                return true;
+            } else if (cmd == "key") {
+                std::string name; in >> name;
+                int key = ScriptKey(name);
+                nullBackend.keysPressed.insert(key);
+                nullBackend.keyQueue.push_back(key);
+                return true;
+            } else if (cmd == "size") {
+                int w = 0, h = 0; in >> w >> h;
+                if (w > 0 && h > 0) nullBackend.SetWindowSize(w, h);
+            } else if (cmd == "catalog") {
+                int n = 0; in >> n;
+                std::string path = "data/bench_products_" + std::to_string(n) + ".txt";
+                if (WriteSyntheticCatalog(n, path)) { productsPath = path; productsLoaded = false; needsResort = true; }
+                else std::cout << "[headless] cannot write " << path << std::endl;
+            } else if (cmd == "users") {
+                // Synthetic in-memory accounts for Manage Accounts benchmarks (never saved unless edited)
+                int n = 0; in >> n;
+                char name[32];
+                for (int k = 0; k < n; ++k) { snprintf(name, sizeof(name), "bench%07d", (int)((long long)k * 7919 % n)); users.push_back({ name, "bench", false }); }
+                ++usersVersion;
+            } else if (cmd == "login") {
+                in >> currentUser;
+                isAdmin = false;
+                for (const auto &u : users) if (u.name == currentUser) { isAdmin = u.isAdmin; break; }
+                currentCart = LoadCart(currentUser); ++cartVersion;
+            } else if (cmd == "goto") {
+                static const std::pair<const char *, AppState> states[] = {
+                    { "login", STATE_LOGIN }, { "register", STATE_REGISTER }, { "menu", STATE_MENU }, { "viewtype", STATE_VIEW_TYPE },
+                    { "catalog", STATE_CATALOG }, { "products", STATE_VIEW_PRODUCTS }, { "cart", STATE_CART },
+                    { "editproducts", STATE_EDIT_PRODUCTS }, { "users", STATE_USER_MANAGEMENT }, { "options", STATE_OPTIONS } };
+                std::string name; in >> name;
+                for (const auto &st : states) if (name == st.first) state = st.second;
+            } else if (cmd == "search") {
+                std::string text; std::getline(in >> std::ws, text);
+                searchInput.Set(text);
+                needsResort = true;
+            } else if (cmd == "mouse") {
+                float x = 0, y = 0; in >> x >> y;
+                Vector2 next = { x * nullBackend.width, y * nullBackend.height };
+                nullBackend.mouseDelta = Vector2{ next.x - nullBackend.mouse.x, next.y - nullBackend.mouse.y };
+                nullBackend.mouse = next;
+            } else if (cmd == "wheel") {
+                in >> nullBackend.wheel;
+            } else if (cmd == "hold" || cmd == "release") {
+                std::string name; in >> name;
+                if (cmd == "hold") nullBackend.keysDown.insert(ScriptKey(name)); else nullBackend.keysDown.erase(ScriptKey(name));
+            } else if (cmd == "text") {
+                std::string text; std::getline(in >> std::ws, text);
+                for (char c : text) nullBackend.charQueue.push_back((unsigned char)c);
+            } else {
+                std::cout << "[headless] unknown command: " << cmd << std::endl;
+            }
+        }
+        nullBackend.quit = true;
+        return false;
+    };
+
+    while (!gBackend->WindowShouldClose() && state != STATE_EXIT) {
+        if (headless && !RunScriptFrame()) break;
+        if (benchText) {
+            benchFrames++;
+            benchCalls += gTextMeasure.calls;
+            benchWalks += gTextMeasure.glyphWalks;
+            benchGlyphs += gTextMeasure.glyphsWalked;
+            if (gBackend->GetTime() - benchStart >= 2.0) {
+                std::cout << "[bench-text] state " << (int)state << " cache " << (gTextMeasure.enabled ? "on " : "off")
+                          << ": " << (double)benchCalls / benchFrames << " measures/frame, "
+                          << (double)benchWalks / benchFrames << " glyph walks/frame, "
+                          << (double)benchGlyphs / benchFrames << " glyphs walked/frame" << std::endl;
+                gTextMeasure.enabled = !gTextMeasure.enabled;
+                benchFrames = 0; benchCalls = benchWalks = benchGlyphs = 0;
+                benchStart = gBackend->GetTime();
+            }
+        }
+        if (benchDraw) {
+            drawBenchFrames++;
+            drawBenchCalls += gDrawStats.frameDrawCalls;
+            drawBenchVertices += gDrawStats.frameVertices;
+            drawBenchSwitches += gDrawStats.frameTextureSwitches;
+            drawBenchMaxCalls = std::max(drawBenchMaxCalls, gDrawStats.frameDrawCalls);
+            if (gBackend->GetTime() - drawBenchStart >= 2.0) {
+                std::cout << "[bench-draw] state " << (int)state << ": " << (double)drawBenchCalls / drawBenchFrames << " draw calls/frame (max "
+                          << drawBenchMaxCalls << "), " << (double)drawBenchVertices / drawBenchFrames << " vertices/frame, "
+                          << (double)drawBenchSwitches / drawBenchFrames << " texture switches/frame" << std::endl;
+                drawBenchFrames = 0; drawBenchCalls = drawBenchVertices = drawBenchSwitches = 0; drawBenchMaxCalls = 0;
+                drawBenchStart = gBackend->GetTime();
+            }
+        }
+        gTextMeasure.BeginFrame();
+        gProfiler.BeginFrame();
+        {
+            ProfileScope loadScope(PROF_LOAD);
+            gThumbnails.Update(0.002); // at most ~2 ms of texture uploads per frame
+        }
+        // Write pending account edits once the admin has paused for a moment or left Manage Accounts
+        if (usersDirty && (state != STATE_USER_MANAGEMENT || gBackend->GetTime() - usersDirtySince > 2.0)) FlushUsers();
+
+        ProfileScope inputScope(PROF_INPUT);
+        if (gBackend->IsKeyPressed(KEY_F3)) gProfiler.Toggle();
 
-    while (!WindowShouldClose() && state != STATE_EXIT) {
         // Handle ESC key navigation
-        if (IsKeyPressed(KEY_ESCAPE)) {
-            if (state == STATE_REGISTER) {
+        if (gBackend->IsKeyPressed(KEY_ESCAPE)) {
+            if (resetModal.open) {
+                resetModal.open = false; // close the overlay, stay on the screen under it
+            } else if (state == STATE_REGISTER) {
                 state = STATE_LOGIN;
             } else if (state != STATE_LOGIN && state != STATE_MENU) {
                 state = STATE_MENU;
             }
         }
         // Global fullscreen toggle (F11) - use smart toggle to avoid stretched scaling
-        if (IsKeyPressed(KEY_F11)) {
+        if (gBackend->IsKeyPressed(KEY_F11)) {
             // Toggle between exclusive fullscreen and windowed-fullscreen (our base mode)
             if (currentWindowMode == WM_FULLSCREEN) ApplyWindowMode(WM_WINDOWED_FULLSCREEN);
             else ApplyWindowMode(WM_FULLSCREEN);
         }
 
+        inputScope.End();
+
         // Begin frame / clear background (required so raylib input buffering and drawing work correctly)
-        BeginDrawing();
-        ClearBackground(colors.background);
+        gBackend->BeginDrawing();
+        gBackend->ClearBackground(colors.background);
 
         // Responsive helpers (used by the drawing/input code)
-        int sw = GetScreenWidth();
-        int sh = GetScreenHeight();
+        int sw = gBackend->GetScreenWidth();
+        int sh = gBackend->GetScreenHeight();
     auto RX = [&](float px)->float { return px * (float)sw; }; // relative x (0..1)
     auto RY = [&](float py)->float { return py * (float)sh; }; // relative y (0..1)
     auto RW = [&](float pw)->float { return pw * (float)sw; }; // relative width
     auto RH = [&](float ph)->float { return ph * (float)sh; }; // relative height
         int centerX = sw / 2;
+        if (sw != layoutW || sh != layoutH || ScaledFontSize(100) != layoutFontPx) {
+            layoutW = sw; layoutH = sh; layoutFontPx = ScaledFontSize(100);
+            ++layoutGeneration;
+        }
+        auto BuildChooserLayout = [&]() -> const ChooserLayout & {
+            ChooserLayout &L = chooserLayout;
+            if (L.generation == layoutGeneration) return L;
+            L.titleY = RY(0.12f);
+            L.noteY = RY(0.20f);
+            float btnW = RW(0.28f); float btnH = RH(0.10f); float gap = RW(0.03f);
+            float startX = centerX - (btnW*2 + gap)/2.0f;
+            float y = RY(0.28f);
+            float y2 = y + btnH + RH(0.04f);
+            L.topLeft = { startX, y, btnW, btnH };
+            L.topRight = { startX + (btnW + gap), y, btnW, btnH };
+            L.bottomLeft = { startX, y2, btnW, btnH };
+            L.bottomRight = { startX + (btnW + gap), y2, btnW, btnH };
+            L.bottomCenter = { RX(0.5f)-(btnW/2), y2, btnW, btnH };
+            float margin = 0.025f;
+            float btnHeight = RH(0.05f);
+            L.backBtn = { (float)RX(margin), (float)RY(margin), RW(0.10f), btnHeight };
+            L.homeBtn = { (float)(L.backBtn.x + L.backBtn.width + RW(0.01f)), (float)RY(margin), btnHeight, btnHeight }; // square
+            L.generation = layoutGeneration;
+            return L;
+        };
+        // Search box of the admin lists (Edit Products, Manage Accounts); returns the lowercase
+        // query. Input goes to the field only while it is focused and enabled.
+        auto BuildAdminSearchLayout = [&]() -> const AdminSearchLayout & {
+            AdminSearchLayout &L = adminSearchLayout;
+            if (L.generation == layoutGeneration) return L;
+            L.box = { RX(0.12f), RY(0.15f), RW(0.30f), RH(0.05f) };
+            L.labelX = (int)RX(0.03f);
+            L.labelY = (int)RY(0.15f);
+            L.countX = (int)RX(0.45f);
+            L.countY = (int)RY(0.16f);
+            L.generation = layoutGeneration;
+            return L;
+        };
+        auto AdminSearchBox = [&](TextField &field, bool &active, bool enabled) -> std::string {
+            const AdminSearchLayout &L = BuildAdminSearchLayout();
+            const Rectangle &box = L.box;
+            if (enabled && gBackend->IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) active = CheckCollisionPointRec(gBackend->GetMousePosition(), box);
+            if (enabled && active) {
+                field.HandleMouse(box, 18);
+                field.HandleKeys();
+            }
+            DrawTextScaled("Search:", L.labelX, L.labelY, 18, colors.text);
+            gBackend->DrawRectangleRec(box, LIGHTGRAY);
+            field.Draw(box, 18, BLACK, enabled && active);
+            if (active) gBackend->DrawRectangleLinesEx(box, 2, BLUE);
+            std::string query = field.Text();
+            std::transform(query.begin(), query.end(), query.begin(), ::tolower);
+            return query;
+        };
+        auto AdminMatchCount = [&](size_t matches, size_t total, const char *noun) {
+            std::string countLine = std::to_string(matches) + " of " + std::to_string(total) + " " + noun;
+            const AdminSearchLayout &L = BuildAdminSearchLayout();
+            DrawTextScaled(countLine.c_str(), L.countX, L.countY, 16, Fade(colors.text, 0.8f));
+        };
+
+        // Everything a cached static layer depends on; any change forces a re-render
+        auto StaticLayerKey = [&]() -> uint64_t {
+            uint64_t h = 1469598103934665603ULL;
+            auto mix = [&](uint64_t v) { h ^= v; h *= 1099511628211ULL; };
+            mix((uint64_t)state); mix((uint64_t)currentTheme); mix((uint64_t)currentWindowMode);
+            mix((uint64_t)sw); mix((uint64_t)sh);
+            mix((uint64_t)isAdmin); mix((uint64_t)menuIndex); mix((uint64_t)productsLoaded); mix((uint64_t)facetsVersion);
+            mix((uint64_t)targetFps); mix((uint64_t)powerSaver);
+            for (char c : currentUser) mix((unsigned char)c);
+            return h;
+        };
+        // Draws a static screen from its cached layer, re-rendering the layer first when stale,
+        // then runs the screen again as an overlay for hover highlights and clicks
+        auto DrawLayeredScreen = [&](const auto &screen) {
+            if (!staticLayerValid || staticLayerKey != StaticLayerKey() ||
+                staticLayer.texture.width != sw || staticLayer.texture.height != sh) {
+                if (staticLayer.texture.width != sw || staticLayer.texture.height != sh) {
+                    if (staticLayer.id != 0) gBackend->UnloadRenderTexture(staticLayer);
+                    staticLayer = gBackend->LoadRenderTexture(sw, sh);
+                }
+                gDrawStats.Flush();
+                gBackend->BeginTextureMode(staticLayer);
+                gBackend->ClearBackground(colors.background);
+                gLayerPass = LAYER_STATIC;
+                screen();
+                gLayerPass = LAYER_DIRECT;
+                gDrawStats.Flush();
+                gBackend->EndTextureMode();
+                staticLayerValid = true;
+                staticLayerKey = StaticLayerKey(); // after the pass: it may have loaded products or facets
+            }
+            // Render textures are stored bottom-up, so flip vertically
+            gBackend->DrawTextureRec(staticLayer.texture, Rectangle{ 0, 0, (float)staticLayer.texture.width, -(float)staticLayer.texture.height }, Vector2{ 0, 0 }, WHITE);
+            if (resetModal.open) return; // a modal owns input; the screen under it stays idle
+            gLayerPass = LAYER_OVERLAY;
+            screen();
+            gLayerPass = LAYER_DIRECT;
+        };
 
+        ProfileScope stateScope(PROF_STATE);
         if (state == STATE_LOGIN) {
-            // place title near top-center (scaled)
-            DrawTextScaled("Login", centerX - MeasureTextScaled("Login", 48)/2, RY(0.12f), 48, colors.primary);
-
-            // Username / Password layout (same positions used for input handling)
-            // Define layout variables
-            int labelX = RX(0.28f);
-            int inputX = RX(0.4625f);
-            int inputW = RW(0.25f);
-            int rowY = RY(0.33f);
-            int passwordRowY = rowY + RH(0.083f);
-            
-            // Create rectangles for input fields (compute RH/RW into floats to avoid narrowing warnings)
-            float inputH = (float)RH(0.05f);
-            float usernameRectX = (float)inputX;
-            float usernameRectY = (float)(rowY - 5);
-            float inputWf = (float)inputW;
-            Rectangle usernameRect = { usernameRectX, usernameRectY, inputWf, inputH };
-            Rectangle passwordRect = { (float)inputX, (float)(passwordRowY - 5), inputWf, inputH };
-            DrawTextScaled("Username:", labelX, rowY, 24, colors.text);
-            DrawRectangleRec(usernameRect, colors.inputBg);
-            DrawTextScaled(username, (int)usernameRect.x + 6, (int)usernameRect.y + 6, 20, colors.text);
-            if (inputFocus == 0) DrawRectangleLinesEx(usernameRect, 2, colors.accent);
+            LoginLayout &L = loginLayout;
+            if (L.generation != layoutGeneration) {
+                // place title near top-center (scaled)
+                L.titleX = centerX - MeasureTextScaled("Login", 48)/2;
+                L.titleY = (int)RY(0.12f);
+
+                // Username / Password layout (same positions used for input handling)
+                L.labelX = RX(0.28f);
+                int inputX = RX(0.4625f);
+                int inputW = RW(0.25f);
+                L.rowY = RY(0.33f);
+                L.passwordRowY = L.rowY + RH(0.083f);
+
+                // Create rectangles for input fields (compute RH/RW into floats to avoid narrowing warnings)
+                float inputH = (float)RH(0.05f);
+                L.usernameRect = { (float)inputX, (float)(L.rowY - 5), (float)inputW, inputH };
+                L.passwordRect = { (float)inputX, (float)(L.passwordRowY - 5), (float)inputW, inputH };
+                L.showPassBtn = { L.passwordRect.x + L.passwordRect.width + 10, L.passwordRect.y, (float)RH(0.05f), L.passwordRect.height };
+
+                float forgotBtnW = (float)RW(0.14f);
+                float forgotBtnH = (float)RH(0.04f);
+                L.forgotBtn = { (float)(centerX) - forgotBtnW/2.0f + RX(0.1f), (float)RY(0.47f), forgotBtnW, forgotBtnH };
+                L.forgotTextX = (int)(L.forgotBtn.x + (L.forgotBtn.width - MeasureTextScaled("forgot password?", 16)) / 2);
+                L.forgotTextY = (int)(L.forgotBtn.y + (L.forgotBtn.height - ScaledFontSize(16)) / 2);
+
+                // Register button centered under inputs
+                float registerBtnW = (float)RW(0.1875f);
+                float registerBtnH = (float)RH(0.05f);
+                L.registerBtn = { (float)(centerX) - registerBtnW/2.0f, (float)RY(0.55f), registerBtnW, registerBtnH };
+                L.failedX = centerX - MeasureTextScaled("Login failed. Try again.", 20)/2;
+                L.failedY = (int)RY(0.85f);
+                L.generation = layoutGeneration;
+            }
+            DrawTextScaled("Login", L.titleX, L.titleY, 48, colors.primary);
+
+            const Rectangle &usernameRect = L.usernameRect;
+            const Rectangle &passwordRect = L.passwordRect;
+            DrawTextScaled("Username:", L.labelX, L.rowY, 24, colors.text);
+            gBackend->DrawRectangleRec(usernameRect, colors.inputBg);
+            username.Draw(usernameRect, 20, colors.text, inputFocus == 0);
+            if (inputFocus == 0) gBackend->DrawRectangleLinesEx(usernameRect, 2, colors.accent);
 
             // Password field with show/hide button
-            DrawTextScaled("Password:", labelX, passwordRowY, 24, colors.text);
-            DrawRectangleRec(passwordRect, colors.inputBg);
-            std::string passDisplay = showPassword ? password : std::string(strlen(password), '*');
-            DrawTextScaled(passDisplay.c_str(), (int)passwordRect.x + 6, (int)passwordRect.y + 6, 20, colors.text);
-            if (inputFocus == 1) DrawRectangleLinesEx(passwordRect, 2, colors.accent);
+            DrawTextScaled("Password:", L.labelX, L.passwordRowY, 24, colors.text);
+            gBackend->DrawRectangleRec(passwordRect, colors.inputBg);
+            password.masked = !showPassword;
+            password.Draw(passwordRect, 20, colors.text, inputFocus == 1);
+            if (inputFocus == 1) gBackend->DrawRectangleLinesEx(passwordRect, 2, colors.accent);
 
             // Add show/hide password button
-            Rectangle showPassBtn = { passwordRect.x + passwordRect.width + 10, passwordRect.y, (float)RH(0.05f), passwordRect.height };
-            if (DrawButton(showPassBtn, showPassword ? "Hide" : "Show", colors.buttonBg, colors, 14)) {
+            if (DrawButton(L.showPassBtn, showPassword ? "Hide" : "Show", colors.buttonBg, colors, 14)) {
                 showPassword = !showPassword;
             }
 
             // Handle mouse focus on inputs
-            Vector2 mousePos = GetMousePosition();
-            if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+            Vector2 mousePos = gBackend->GetMousePosition();
+            if (gBackend->IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
                 if (CheckCollisionPointRec(mousePos, usernameRect)) inputFocus = 0;
                 else if (CheckCollisionPointRec(mousePos, passwordRect)) inputFocus = 1;
                 else inputFocus = -1;
             }
+            if (inputFocus == 0) username.HandleMouse(usernameRect, 20);
+            else if (inputFocus == 1) password.HandleMouse(passwordRect, 20);
 
             // Remove the space key toggle for password visibility
             // Tab to switch fields (must click first or press Tab to focus)
-            if (IsKeyPressed(KEY_TAB)) {
+            if (gBackend->IsKeyPressed(KEY_TAB)) {
                 if (inputFocus < 0) inputFocus = 0;
                 else inputFocus = (inputFocus + 1) % 2;
             }
 
             // Enter to attempt login (works from any focus)
-            if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_KP_ENTER)) {
-                std::string su = std::string(username);
-                std::string sp = std::string(password);
+            if (gBackend->IsKeyPressed(KEY_ENTER) || gBackend->IsKeyPressed(KEY_KP_ENTER)) {
+                std::string su = username.Text();
+                std::string sp = password.Text();
                 if (CheckLogin(users, su, sp)) {
                     currentUser = su;
                     // Determine admin flag from loaded users
@@ -658,47 +3280,25 @@ int main() {
                     for (const auto &u : users) { if (u.name == currentUser) { isAdmin = u.isAdmin; break; } }
                     loginFailed = false;
                     // load user's cart
-                    currentCart = LoadCart(currentUser);
+                    currentCart = LoadCart(currentUser); ++cartVersion;
                     state = STATE_MENU;
                     // clear sensitive buffer if you want:
-                    // memset(password, 0, sizeof(password));
+                    // password.Clear();
                 } else {
                     loginFailed = true;
                 }
             }
 
-            // Typing / backspace for the focused field
-            if (inputFocus == 0 || inputFocus == 1) {
-                int key = GetCharPressed();
-                while (key > 0) {
-                    if (key >= 32 && key <= 125) {
-                        if (inputFocus == 0 && strlen(username) < (int)(sizeof(username) - 1)) {
-                            int len = strlen(username);
-                            username[len] = (char)key; username[len+1] = '\0';
-                        } else if (inputFocus == 1 && strlen(password) < (int)(sizeof(password) - 1)) {
-                            int len = strlen(password);
-                            password[len] = (char)key; password[len+1] = '\0';
-                        }
-                    }
-                    key = GetCharPressed();
-                }
-                if (IsKeyPressed(KEY_BACKSPACE)) {
-                    if (inputFocus == 0 && strlen(username) > 0) username[strlen(username)-1] = '\0';
-                    if (inputFocus == 1 && strlen(password) > 0) password[strlen(password)-1] = '\0';
-                }
-            }
+            // Typing, editing and clipboard for the focused field
+            if (inputFocus == 0) username.HandleKeys();
+            else if (inputFocus == 1) password.HandleKeys();
 
-            float forgotBtnW = (float)RW(0.14f);
-            float forgotBtnH = (float)RH(0.04f);
-            Rectangle forgotBtn = { (float)(centerX) - forgotBtnW/2.0f + RX(0.1f), (float)RY(0.47f), forgotBtnW, forgotBtnH };
-            Vector2 mouse = GetMousePosition();
-            bool hovered = CheckCollisionPointRec(mouse, forgotBtn);
+            Vector2 mouse = gBackend->GetMousePosition();
+            bool hovered = CheckCollisionPointRec(mouse, L.forgotBtn);
             Color color = hovered ? Fade(colors.background, 0.8f) : colors.background;
-            DrawRectangleRec(forgotBtn, color);
-            int textWidth = MeasureTextScaled("forgot password?", 16);
-            int textHeight = ScaledFontSize(16);
-            DrawTextScaled("forgot password?", (int)(forgotBtn.x + (forgotBtn.width - textWidth) / 2), (int)(forgotBtn.y + (forgotBtn.height - textHeight) / 2), 16, colors.primary);
-            if (hovered && IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
+            gBackend->DrawRectangleRec(L.forgotBtn, color);
+            DrawTextScaled("forgot password?", L.forgotTextX, L.forgotTextY, 16, colors.primary);
+            if (hovered && gBackend->IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
                 state = STATE_FORGOTPASSWORD;
                 strcpy(regUsername, "");
                 strcpy(regPassword, "");
@@ -709,10 +3309,7 @@ int main() {
             }
 
             // Register button centered under inputs
-            float registerBtnW = (float)RW(0.1875f);
-            float registerBtnH = (float)RH(0.05f);
-            Rectangle registerBtn = { (float)(centerX) - registerBtnW/2.0f, (float)RY(0.55f), registerBtnW, registerBtnH };
-            if (DrawButton(registerBtn, "Register New User", colors.secondary, colors, 16)) {
+            if (DrawButton(L.registerBtn, "Register New User", colors.secondary, colors, 16)) {
                 state = STATE_REGISTER;
                 strcpy(regUsername, "");
                 strcpy(regPassword, "");
@@ -723,96 +3320,104 @@ int main() {
             }
 
             if (loginFailed)
-                DrawTextScaled("Login failed. Try again.", centerX - MeasureTextScaled("Login failed. Try again.", 20)/2, RY(0.85f), 20, RED);
+                DrawTextScaled("Login failed. Try again.", L.failedX, L.failedY, 20, RED);
         }
         else if (state == STATE_FORGOTPASSWORD) {
-            DrawTextScaled("Forgot Password", centerX - MeasureTextScaled("Forgot Password", 32)/2, RY(0.12f), 32, colors.primary);
-            DrawTextScaled("Please enter your username below and we'll email you a reset code.", centerX - MeasureTextScaled("Please enter your username below and we'll email you a reset code.", 18)/2, RY(0.22f), 18, colors.text);
+            ForgotLayout &L = forgotLayout;
+            if (L.generation != layoutGeneration) {
+                L.titleX = centerX - MeasureTextScaled("Forgot Password", 32)/2;
+                L.titleY = (int)RY(0.12f);
+                L.introX = centerX - MeasureTextScaled("Please enter your username below and we'll email you a reset code.", 18)/2;
+                L.introY = (int)RY(0.22f);
+                // Username step
+                float inputY = RY(0.32f);
+                L.userRect = { (float)(centerX - RW(0.1f)), inputY, (float)RW(0.2f), (float)RH(0.06f) };
+                L.sendBtn = { (float)(centerX - RW(0.15f)), inputY + RH(0.08f), (float)RW(0.3f), (float)RH(0.06f) };
+                L.sendingX = centerX - MeasureTextScaled("Sending email...", 18)/2;
+                // Code and new password steps share one field position
+                L.codePromptX = centerX - MeasureTextScaled("Enter the verification code sent to your email:", 18)/2;
+                L.passPromptX = centerX - MeasureTextScaled("Enter your new password:", 18)/2;
+                L.promptY = (int)RY(0.32f);
+                float fieldY = RY(0.38f);
+                L.fieldRect = { (float)(centerX - RW(0.15f)), fieldY, (float)RW(0.3f), (float)RH(0.06f) };
+                L.confirmBtn = { (float)(centerX - RW(0.15f)), fieldY + RH(0.08f), (float)RW(0.3f), (float)RH(0.06f) };
+                L.errorY = (int)(fieldY + RH(0.16f));
+                L.generation = layoutGeneration;
+            }
+            DrawTextScaled("Forgot Password", L.titleX, L.titleY, 32, colors.primary);
+            DrawTextScaled("Please enter your username below and we'll email you a reset code.", L.introX, L.introY, 18, colors.text);
 
-            static char forgotUser[32] = "";
+            static TextField forgotUser(31);
             static bool emailSent = false;
             static bool codeEntered = false;
             static char verifyCode[8] = "";
             static bool forgotFocus = false;
             static bool codeFocus = false;
-            static std::string newPassword = "";
+            static TextField newPassword(127);
             static bool newPasswordFocus = false;
             static std::string resetError = "";
             static bool passwordReset = false;
 
             if (!emailSent) {
                 // Username input
-                float inputY = RY(0.32f);
-                Rectangle userRect = { (float)(centerX - RW(0.1f)), inputY, (float)RW(0.2f), (float)RH(0.06f) };
-                DrawRectangleRec(userRect, colors.inputBg);
-                DrawTextScaled(forgotUser, (int)userRect.x + 6, (int)userRect.y + 6, 20, colors.text);
-                if (forgotFocus) DrawRectangleLinesEx(userRect, 2, colors.accent);
+                const Rectangle &userRect = L.userRect;
+                gBackend->DrawRectangleRec(userRect, colors.inputBg);
+                forgotUser.Draw(userRect, 20, colors.text, forgotFocus);
+                if (forgotFocus) gBackend->DrawRectangleLinesEx(userRect, 2, colors.accent);
 
                 // Handle input focus
-                Vector2 mouse = GetMousePosition();
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+                Vector2 mouse = gBackend->GetMousePosition();
+                if (gBackend->IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
                     forgotFocus = CheckCollisionPointRec(mouse, userRect);
                 }
 
                 if (forgotFocus) {
-                    int key = GetCharPressed();
-                    while (key > 0) {
-                        if (key >= 32 && key <= 125 && strlen(forgotUser) < 31) {
-                            int len = strlen(forgotUser);
-                            forgotUser[len] = (char)key;
-                            forgotUser[len+1] = '\0';
-                        }
-                        key = GetCharPressed();
-                    }
-                    if (IsKeyPressed(KEY_BACKSPACE) && strlen(forgotUser) > 0) {
-                        forgotUser[strlen(forgotUser)-1] = '\0';
-                    }
+                    forgotUser.HandleMouse(userRect, 20);
+                    forgotUser.HandleKeys();
                 }
 
                 // Send code button
-                Rectangle sendBtn = { (float)(centerX - RW(0.15f)), inputY + RH(0.08f), (float)RW(0.3f), (float)RH(0.06f) };
+                const Rectangle &sendBtn = L.sendBtn;
                 if (DrawButton(sendBtn, "Send Reset Code", colors.primary, colors, 20)) {
-                    if (strlen(forgotUser) > 0) {
+                    if (!forgotUser.Empty()) {
                         emailSent = true;
                         // Simulate sending email (in real app, send actual email)
-                        DrawTextScaled("Sending email...", centerX - MeasureTextScaled("Sending email...", 18)/2, (int)(sendBtn.y + sendBtn.height + 10), 18, colors.text);
+                        DrawTextScaled("Sending email...", L.sendingX, (int)(sendBtn.y + sendBtn.height + 10), 18, colors.text);
                     }
                 }
             }
             else if (!codeEntered) {
                 // Show verification code input
-                DrawTextScaled("Enter the verification code sent to your email:", centerX - MeasureTextScaled("Enter the verification code sent to your email:", 18)/2, RY(0.32f), 18, colors.text);
+                DrawTextScaled("Enter the verification code sent to your email:", L.codePromptX, L.promptY, 18, colors.text);
 
-                float codeY = RY(0.38f);
-                Rectangle codeRect = { (float)(centerX - RW(0.15f)), codeY, (float)RW(0.3f), (float)RH(0.06f) };
-                DrawRectangleRec(codeRect, colors.inputBg);
+                const Rectangle &codeRect = L.fieldRect;
+                gBackend->DrawRectangleRec(codeRect, colors.inputBg);
                 DrawTextScaled(verifyCode, (int)codeRect.x + 6, (int)codeRect.y + 6, 20, colors.text);
-                if (codeFocus) DrawRectangleLinesEx(codeRect, 2, colors.accent);
+                if (codeFocus) gBackend->DrawRectangleLinesEx(codeRect, 2, colors.accent);
 
                 // Handle code input
-                Vector2 mouse = GetMousePosition();
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+                Vector2 mouse = gBackend->GetMousePosition();
+                if (gBackend->IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
                     codeFocus = CheckCollisionPointRec(mouse, codeRect);
                 }
 
                 if (codeFocus) {
-                    int key = GetCharPressed();
+                    int key = gBackend->GetCharPressed();
                     while (key > 0) {
                         if (key >= 32 && key <= 125 && strlen(verifyCode) < 7) {
                             int len = strlen(verifyCode);
                             verifyCode[len] = (char)key;
                             verifyCode[len+1] = '\0';
                         }
-                        key = GetCharPressed();
+                        key = gBackend->GetCharPressed();
                     }
-                    if (IsKeyPressed(KEY_BACKSPACE) && strlen(verifyCode) > 0) {
+                    if (gBackend->IsKeyPressed(KEY_BACKSPACE) && strlen(verifyCode) > 0) {
                         verifyCode[strlen(verifyCode)-1] = '\0';
                     }
                 }
 
                 // Verify button
-                Rectangle verifyBtn = { (float)(centerX - RW(0.15f)), codeY + RH(0.08f), (float)RW(0.3f), (float)RH(0.06f) };
-                if (DrawButton(verifyBtn, "Verify Code", colors.primary, colors, 20)) {
+                if (DrawButton(L.confirmBtn, "Verify Code", colors.primary, colors, 20)) {
                     if (strlen(verifyCode) > 0) {
                         // Any code works for demo purposes
                         codeEntered = true;
@@ -822,47 +3427,37 @@ int main() {
             }
             else {
                 // Show password reset form
-                DrawTextScaled("Enter your new password:", centerX - MeasureTextScaled("Enter your new password:", 18)/2, RY(0.32f), 18, colors.text);
+                DrawTextScaled("Enter your new password:", L.passPromptX, L.promptY, 18, colors.text);
 
-                float passY = RY(0.38f);
-                Rectangle passRect = { (float)(centerX - RW(0.15f)), passY, (float)RW(0.3f), (float)RH(0.06f) };
-                DrawRectangleRec(passRect, colors.inputBg);
-                std::string maskedPass = std::string(newPassword.size(), '*');
-                DrawTextScaled(maskedPass.c_str(), (int)passRect.x + 6, (int)passRect.y + 6, 20, colors.text);
-                if (newPasswordFocus) DrawRectangleLinesEx(passRect, 2, colors.accent);
+                const Rectangle &passRect = L.fieldRect;
+                gBackend->DrawRectangleRec(passRect, colors.inputBg);
+                newPassword.masked = true;
+                newPassword.Draw(passRect, 20, colors.text, newPasswordFocus);
+                if (newPasswordFocus) gBackend->DrawRectangleLinesEx(passRect, 2, colors.accent);
 
                 // Handle password input focus
-                Vector2 mouse = GetMousePosition();
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+                Vector2 mouse = gBackend->GetMousePosition();
+                if (gBackend->IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
                     newPasswordFocus = CheckCollisionPointRec(mouse, passRect);
                 }
 
                 if (newPasswordFocus) {
-                    int key = GetCharPressed();
-                    while (key > 0) {
-                        if (key >= 32 && key <= 125 && newPassword.size() < 127) {
-                            newPassword.push_back((char)key);
-                        }
-                        key = GetCharPressed();
-                    }
-                    if (IsKeyPressed(KEY_BACKSPACE) && !newPassword.empty()) {
-                        newPassword.pop_back();
-                    }
+                    newPassword.HandleMouse(passRect, 20);
+                    newPassword.HandleKeys();
                 }
 
                 // Set Password button
-                Rectangle setBtn = { (float)(centerX - RW(0.15f)), passY + RH(0.08f), (float)RW(0.3f), (float)RH(0.06f) };
-                if (DrawButton(setBtn, "Set Password", colors.primary, colors, 20)) {
-                    if (newPassword.empty()) {
+                if (DrawButton(L.confirmBtn, "Set Password", colors.primary, colors, 20)) {
+                    if (newPassword.Empty()) {
                         resetError = "Please enter a new password.";
-                    } else if (newPassword.length() < 3) {
+                    } else if (newPassword.Length() < 3) {
                         resetError = "Password must be at least 3 characters.";
                     } else {
                         // Update the user's password
                         bool userFound = false;
                         for (auto &u : users) {
-                            if (u.name == std::string(forgotUser)) {
-                                u.pass = newPassword;
+                            if (u.name == forgotUser.Text()) {
+                                u.pass = newPassword.Text();
                                 SaveAllUsers();
                                 userFound = true;
                                 break;
@@ -870,7 +3465,7 @@ int main() {
                         }
                         if (userFound) {
                             // Success: automatically log in and go to menu
-                            currentUser = std::string(forgotUser);
+                            currentUser = forgotUser.Text();
                             // Determine admin flag
                             isAdmin = false;
                             for (const auto &u : users) {
@@ -880,16 +3475,16 @@ int main() {
                                 }
                             }
                             // Load user's cart
-                            currentCart = LoadCart(currentUser);
+                            currentCart = LoadCart(currentUser); ++cartVersion;
                             state = STATE_MENU;
                             // Reset all forgot password state
-                            memset(forgotUser, 0, sizeof(forgotUser));
+                            forgotUser.Clear();
                             memset(verifyCode, 0, sizeof(verifyCode));
                             emailSent = false;
                             codeEntered = false;
                             forgotFocus = false;
                             codeFocus = false;
-                            newPassword.clear();
+                            newPassword.Clear();
                             newPasswordFocus = false;
                             resetError = "";
                         } else {
@@ -900,36 +3495,62 @@ int main() {
 
                 // Show any error
                 if (!resetError.empty()) {
-                    DrawTextScaled(resetError.c_str(), centerX - MeasureTextScaled(resetError.c_str(), 16)/2, passY + RH(0.16f), 16, RED);
+                    DrawTextScaled(resetError.c_str(), centerX - MeasureTextScaled(resetError.c_str(), 16)/2, L.errorY, 16, RED);
                 }
             }
         }
         else if (state == STATE_REGISTER) {
-            DrawTextScaled("Register New User", centerX - MeasureTextScaled("Register New User", 32)/2, RY(0.12f), 32, colors.primary);
-            DrawTextScaled("Press ESC to return to login", centerX - MeasureTextScaled("Press ESC to return to login", 16)/2, RY(0.17f), 16, colors.accent);
-            
-            // registration inputs - use same layout logic as login (centered)
-            int rLabelX = RX(0.28f);
-            int rInputX = RX(0.4625f);
-            int rInputW = RW(0.25f);
-            int rY = RY(0.28f);
-            float inputH = (float)RH(0.05f);
+            RegisterLayout &L = registerLayout;
+            if (L.generation != layoutGeneration) {
+                L.titleX = centerX - MeasureTextScaled("Register New User", 32)/2;
+                L.titleY = (int)RY(0.12f);
+                L.hintX = centerX - MeasureTextScaled("Press ESC to return to login", 16)/2;
+                L.hintY = (int)RY(0.17f);
+
+                // registration inputs - use same layout logic as login (centered)
+                int rLabelX = RX(0.28f);
+                int rInputX = RX(0.4625f);
+                int rInputW = RW(0.25f);
+                int rY = RY(0.28f);
+                float inputH = (float)RH(0.05f);
+                L.labelX = rLabelX;
+                L.usernameY = rY;
+                L.passwordY = rY + RH(0.083f);
+                L.confirmX = rLabelX - RW(0.05f);
+                L.confirmY = rY + RH(0.166f);
+                L.usernameRect = { (float)rInputX, (float)(rY - 5), (float)rInputW, inputH };
+                L.passwordRect = { (float)rInputX, (float)(rY + RH(0.078f)), (float)rInputW, inputH };
+                L.confirmRect = { (float)rInputX, (float)(rY + RH(0.161f)), (float)rInputW, inputH };
+                L.showPassBtn = { L.confirmRect.x + L.confirmRect.width + 10, L.passwordRect.y, (float)RH(0.05f), inputH };
+
+                // Action buttons
+                float btnWidth = RW(0.15f);
+                float btnHeight = RH(0.06f);
+                float squareSize = btnHeight;
+                L.backBtn = { (float)RX(0.30f), (float)RY(0.55f), btnWidth, btnHeight };
+                L.homeBtn = { (float)(L.backBtn.x + L.backBtn.width + RW(0.02f)), (float)RY(0.55f), squareSize, squareSize };
+                L.registerBtn = { (float)(L.homeBtn.x + L.homeBtn.width + RW(0.02f)), (float)RY(0.55f), btnWidth, btnHeight };
+                L.messageY = (int)RY(0.70f);
+                L.generation = layoutGeneration;
+            }
+            DrawTextScaled("Register New User", L.titleX, L.titleY, 32, colors.primary);
+            DrawTextScaled("Press ESC to return to login", L.hintX, L.hintY, 16, colors.accent);
 
             // Username field
-            Rectangle usernameRect = { (float)rInputX, (float)(rY - 5), (float)rInputW, inputH };
-            DrawTextScaled("Username:", rLabelX, rY, 24, colors.text);
-            DrawRectangleRec(usernameRect, colors.inputBg);
+            const Rectangle &usernameRect = L.usernameRect;
+            DrawTextScaled("Username:", L.labelX, L.usernameY, 24, colors.text);
+            gBackend->DrawRectangleRec(usernameRect, colors.inputBg);
             DrawTextScaled(regUsername, (int)usernameRect.x + 6, (int)usernameRect.y + 6, 20, colors.text);
-            if (regInputFocus == 0) DrawRectangleLinesEx(usernameRect, 2, colors.accent);
+            if (regInputFocus == 0) gBackend->DrawRectangleLinesEx(usernameRect, 2, colors.accent);
 
             // Password field
-            Rectangle passwordRect = { (float)rInputX, (float)(rY + RH(0.078f)), (float)rInputW, inputH };
-            DrawTextScaled("Password:", rLabelX, rY + RH(0.083f), 24, colors.text);
-            DrawRectangleRec(passwordRect, colors.inputBg);
+            const Rectangle &passwordRect = L.passwordRect;
+            DrawTextScaled("Password:", L.labelX, L.passwordY, 24, colors.text);
+            gBackend->DrawRectangleRec(passwordRect, colors.inputBg);
             std::string passDisplay = regShowPassword ? regPassword : std::string(strlen(regPassword), '*');
             DrawTextScaled(passDisplay.c_str(), (int)passwordRect.x + 6, (int)passwordRect.y + 6, 20, colors.text);
             if (regInputFocus == 1) {
-                DrawRectangleLinesEx(passwordRect, 2, colors.accent);
+                gBackend->DrawRectangleLinesEx(passwordRect, 2, colors.accent);
                 
                 // Show password requirements
                 const char* passReq = "Password must have at least 8 characters, letters and numbers";
@@ -945,27 +3566,26 @@ int main() {
                 }
                 
                 if(pass.length() < 8 || !hasLetter || !hasNumber) {
-                    DrawRectangleLinesEx(passwordRect, 2, RED); // Show red border for invalid password
+                    gBackend->DrawRectangleLinesEx(passwordRect, 2, RED); // Show red border for invalid password
                 }
             }
 
             // Confirm Password field
-            Rectangle confirmRect = { (float)rInputX, (float)(rY + RH(0.161f)), (float)rInputW, inputH };
-            DrawTextScaled("Confirm Password:", rLabelX - RW(0.05f), rY + RH(0.166f), 20, colors.text);
-            DrawRectangleRec(confirmRect, colors.inputBg);
+            const Rectangle &confirmRect = L.confirmRect;
+            DrawTextScaled("Confirm Password:", L.confirmX, L.confirmY, 20, colors.text);
+            gBackend->DrawRectangleRec(confirmRect, colors.inputBg);
             std::string confirmDisplay = regShowPassword ? regConfirmPassword : std::string(strlen(regConfirmPassword), '*');
             DrawTextScaled(confirmDisplay.c_str(), (int)confirmRect.x + 6, (int)confirmRect.y + 6, 20, colors.text);
-            if (regInputFocus == 2) DrawRectangleLinesEx(confirmRect, 2, colors.accent);
+            if (regInputFocus == 2) gBackend->DrawRectangleLinesEx(confirmRect, 2, colors.accent);
 
             // Show/Hide password button
-            Rectangle showPassBtn = { confirmRect.x + confirmRect.width + 10, passwordRect.y, (float)RH(0.05f), inputH };
-            if (DrawButton(showPassBtn, regShowPassword ? "Hide" : "Show", colors.buttonBg, colors, 14)) {
+            if (DrawButton(L.showPassBtn, regShowPassword ? "Hide" : "Show", colors.buttonBg, colors, 14)) {
                 regShowPassword = !regShowPassword;
             }
 
             // Handle mouse focus on inputs
-            Vector2 mousePos = GetMousePosition();
-            if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+            Vector2 mousePos = gBackend->GetMousePosition();
+            if (gBackend->IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
                 if (CheckCollisionPointRec(mousePos, usernameRect)) regInputFocus = 0;
                 else if (CheckCollisionPointRec(mousePos, passwordRect)) regInputFocus = 1;
                 else if (CheckCollisionPointRec(mousePos, confirmRect)) regInputFocus = 2;
@@ -973,12 +3593,12 @@ int main() {
             }
 
             // Tab to switch fields
-            if (IsKeyPressed(KEY_TAB)) {
+            if (gBackend->IsKeyPressed(KEY_TAB)) {
                 regInputFocus = (regInputFocus + 1) % 3;
             }
 
             // Input handling for active field
-            int key = GetCharPressed();
+            int key = gBackend->GetCharPressed();
             while (key > 0) {
                 if (key >= 32 && key <= 125) {
                     if (regInputFocus == 0 && strlen(regUsername) < sizeof(regUsername) - 1) {
@@ -995,30 +3615,23 @@ int main() {
                         regConfirmPassword[len + 1] = '\0';
                     }
                 }
-                key = GetCharPressed();
+                key = gBackend->GetCharPressed();
             }
 
-            if (IsKeyPressed(KEY_BACKSPACE)) {
+            if (gBackend->IsKeyPressed(KEY_BACKSPACE)) {
                 if (regInputFocus == 0 && strlen(regUsername) > 0) regUsername[strlen(regUsername)-1] = '\0';
                 else if (regInputFocus == 1 && strlen(regPassword) > 0) regPassword[strlen(regPassword)-1] = '\0';
                 else if (regInputFocus == 2 && strlen(regConfirmPassword) > 0) regConfirmPassword[strlen(regConfirmPassword)-1] = '\0';
             }
 
             // Action buttons
-            float btnWidth = RW(0.15f);
-            float btnHeight = RH(0.06f);
-            float squareSize = btnHeight;
-            Rectangle backBtn = { (float)RX(0.30f), (float)RY(0.55f), btnWidth, btnHeight };
-            Rectangle homeBtn = { (float)(backBtn.x + backBtn.width + RW(0.02f)), (float)RY(0.55f), squareSize, squareSize };
-            Rectangle registerBtn = { (float)(homeBtn.x + homeBtn.width + RW(0.02f)), (float)RY(0.55f), btnWidth, btnHeight };
-
-            if (DrawButton(backBtn, "< Back", colors.buttonBg, colors, 16)) {
+            if (DrawButton(L.backBtn, "< Back", colors.buttonBg, colors, 16)) {
                 state = STATE_LOGIN;
             }
-            if (DrawButton(homeBtn, homeIcon, colors.buttonBg, colors)) {
+            if (DrawButton(L.homeBtn, homeIcon, colors.buttonBg, colors)) {
                 state = STATE_MENU;
             }
-            if (DrawButton(registerBtn, "Register", colors.primary, colors, 16)) {
+            if (DrawButton(L.registerBtn, "Register", colors.primary, colors, 16)) {
                 // Registration validation logic
                 std::string regUser = std::string(regUsername);
                 std::string regPass = std::string(regPassword);
@@ -1054,184 +3667,261 @@ int main() {
             // Show message (if any)
             if (!regMessage.empty()) {
                 Color msgColor = regFailed ? RED : GREEN;
-                DrawTextScaled(regMessage.c_str(), centerX - MeasureTextScaled(regMessage.c_str(), 18)/2, RY(0.70f), 18, msgColor);
+                DrawTextScaled(regMessage.c_str(), centerX - MeasureTextScaled(regMessage.c_str(), 18)/2, L.messageY, 18, msgColor);
             }
         }
-        else if (state == STATE_MENU) {
-            // Logout button in top-left (use margin)
-            float margin = 0.025f;
-            Rectangle logoutBtn = { (float)RX(margin), (float)RY(margin), (float)RW(0.125f), (float)RH(0.05f) };
-            if (DrawButton(logoutBtn, "< Logout", colors.buttonBg, colors, 16)) {
+        else if (state == STATE_MENU) DrawLayeredScreen([&]() {
+            MenuLayout &L = menuLayout;
+            if (L.generation != layoutGeneration) {
+                // Logout button in top-left (use margin), options button top-right
+                float margin = 0.025f;
+                L.logoutBtn = { (float)RX(margin), (float)RY(margin), (float)RW(0.125f), (float)RH(0.05f) };
+                L.optionsBtn = { (float)(sw - RW(0.13f)), (float)RY(margin), (float)RW(0.10f), (float)RH(0.05f) };
+                L.userInfoY = RY(margin) + 6;
+
+                // Title and logo side by side, centered at the gap
+                int titleWidth = MeasureTextScaled("Pepka", 60);
+                float logoScale = 0.5f; // adjust this to make the logo smaller/larger
+                int gap = 20; // gap between text and logo
+                // Calculate positions so the gap is at screen center
+                L.pepkaX = centerX - (titleWidth + gap/2); // Text ends at center minus half gap
+                L.pepkaY = (int)RY(0.25f);
+                float textHeight = (float)ScaledFontSize(60);
+                L.logoPos = { (float)(centerX + gap/2), // Logo starts at center plus half gap
+                              (float)RY(0.25f) + (textHeight - logo.source.height * logoScale) / 2.0f };
+
+                // Menu buttons stack (aligned vertically with consistent spacing)
+                float menuBaseY = RY(0.42f);
+                L.menuSpacing = RH(0.12f);
+                L.btnView = { (float)(centerX - RW(0.125f)), (float)menuBaseY, (float)RW(0.25f), (float)RH(0.1f) };
+                L.btnCart = L.btnView; L.btnCart.y += L.menuSpacing;
+                L.btnAdd = L.btnView; L.btnAdd.y += L.menuSpacing*2.0f;
+                L.btnManage = L.btnView; L.btnManage.y += L.menuSpacing*3.0f;
+                L.generation = layoutGeneration;
+            }
+            if (DrawButton(L.logoutBtn, "< Logout", colors.buttonBg, colors, 16)) {
                  // Clear user data and return to login
                  currentUser = "";
                  isAdmin = false;
-                 strcpy(username, "");
-                 strcpy(password, "");
+                 username.Clear();
+                 password.Clear();
                  inputFocus = 0;
                  showPassword = false;
                  loginFailed = false;
                  state = STATE_LOGIN;
              }
              
-            // Options button top-right
-            Rectangle optionsBtn = { (float)(sw - RW(0.13f)), (float)RY(margin), (float)RW(0.10f), (float)RH(0.05f) };
-            if (DrawButton(optionsBtn, "Options", colors.buttonBg, colors, 16)) {
+            if (DrawButton(L.optionsBtn, "Options", colors.buttonBg, colors, 16)) {
                 state = STATE_OPTIONS;
             }
             
             // Show current user info to left of options button
             std::string userInfo = "Logged in as: " + currentUser;
             if (isAdmin) userInfo += " (Admin)";
-            DrawTextScaled(userInfo.c_str(), (int)(optionsBtn.x - 10 - MeasureTextScaled(userInfo.c_str(), 16)), RY(margin) + 6, 16, colors.accent);
-             
-            // Title and logo side by side, centered at the gap
-            int titleWidth = MeasureTextScaled("Pepka", 60);
-            float logoScale = 0.5f; // adjust this to make the logo smaller/larger
-            int scaledLogoWidth = (int)(logo.width * logoScale);
-            int gap = 20; // gap between text and logo
-            
-            // Calculate positions so the gap is at screen center
-            int pepkaX = centerX - (titleWidth + gap/2); // Text ends at center minus half gap
-            float textHeight = (float)ScaledFontSize(60);
-            Vector2 logoPos = { (float)(centerX + gap/2), // Logo starts at center plus half gap
-                               (float)RY(0.25f) + (textHeight - logo.height * logoScale) / 2.0f };
-            
-            DrawTextScaled("Pepka", pepkaX, RY(0.25f), 60, colors.primary);
-            DrawTextureEx(logo, logoPos, 0.0f, logoScale, WHITE);
+            DrawTextScaled(userInfo.c_str(), (int)(L.optionsBtn.x - 10 - MeasureTextScaled(userInfo.c_str(), 16)), L.userInfoY, 16, colors.accent);
+
+            DrawTextScaled("Pepka", L.pepkaX, L.pepkaY, 60, colors.primary);
+            if (gLayerPass != LAYER_OVERLAY) DrawSprite(logo, Rectangle{ L.logoPos.x, L.logoPos.y, logo.source.width * 0.5f, logo.source.height * 0.5f }, WHITE);
 
-            // Menu buttons stack (aligned vertically with consistent spacing)
-            float menuBaseY = RY(0.42f);
-            float menuSpacing = RH(0.12f);
-            Rectangle btnView = { (float)(centerX - RW(0.125f)), (float)menuBaseY, (float)RW(0.25f), (float)RH(0.1f) };
-            if (DrawButton(btnView, "View Products", colors.buttonBg, colors, 28)) state = STATE_VIEW_TYPE;
+            if (DrawButton(L.btnView, "View Products", colors.buttonBg, colors, 28)) state = STATE_VIEW_TYPE;
 
             // Cart button (visible when logged in) placed under View
-            Rectangle btnCart = { (float)(centerX - RW(0.125f)), (float)(menuBaseY + menuSpacing), (float)RW(0.25f), (float)RH(0.1f) };
             if (!currentUser.empty()) {
-                if (DrawButton(btnCart, "Cart", colors.buttonBg, colors, 28)) state = STATE_CART;
+                if (DrawButton(L.btnCart, "Cart", colors.buttonBg, colors, 28)) state = STATE_CART;
             }
 
             // Only show Add Product button if admin (placed under Cart)
             if (isAdmin) {
-                Rectangle btnAdd = { (float)(centerX - RW(0.125f)), (float)(menuBaseY + menuSpacing*2.0f), (float)RW(0.25f), (float)RH(0.1f) };
-                if (DrawButton(btnAdd, "Edit Product", colors.buttonBg, colors, 28)) state = STATE_EDIT_PRODUCTS;
+                if (DrawButton(L.btnAdd, "Edit Product", colors.buttonBg, colors, 28)) state = STATE_EDIT_PRODUCTS;
 
                 // Manage Accounts button (admin-only)
-                Rectangle btnManage = { (float)(centerX - RW(0.125f)), (float)(menuBaseY + menuSpacing*3.0f), (float)RW(0.25f), (float)RH(0.1f) };
-                if (DrawButton(btnManage, "Manage Accounts", colors.buttonBg, colors, 24)) state = STATE_USER_MANAGEMENT;
+                if (DrawButton(L.btnManage, "Manage Accounts", colors.buttonBg, colors, 24)) state = STATE_USER_MANAGEMENT;
 
                 // Move selector highlight based on menu index (uses uniform spacing)
-                Rectangle selector = { btnView.x, btnView.y + menuIndex * menuSpacing, btnView.width, btnView.height };
-                DrawRectangleLinesEx(selector, 3, DARK_ACCENT);
+                Rectangle selector = { L.btnView.x, L.btnView.y + menuIndex * L.menuSpacing, L.btnView.width, L.btnView.height };
+                if (gLayerPass != LAYER_OVERLAY) gBackend->DrawRectangleLinesEx(selector, 3, DARK_ACCENT);
             } else {
                 // Just highlight the view button for non-admin users
-                DrawRectangleLinesEx(btnView, 3, DARK_ACCENT);
+                if (gLayerPass != LAYER_OVERLAY) gBackend->DrawRectangleLinesEx(L.btnView, 3, DARK_ACCENT);
             }
-         }
-        else if (state == STATE_CATALOG) {
+         });
+        else if (state == STATE_CATALOG) DrawLayeredScreen([&]() {
+            // Keep the catalog loaded here too so the buttons can show live facet counts
+            if (!productsLoaded) productsLoaded = LoadProducts(productsPath);
+            if (needsResort) FilterAndSortProducts();
+
             // Simple category selector before viewing products
-            DrawTextScaled("Choose a category", centerX - MeasureTextScaled("Choose a category", 28)/2, RY(0.12f), 28, colors.primary);
-            float btnW = RW(0.28f); float btnH = RH(0.10f); float gap = RW(0.03f);
-            float startX = centerX - (btnW*2 + gap)/2.0f;
-            float y = RY(0.28f);
-            //Rectangle catKids = { startX, y, btnW, btnH };
-            //Rectangle catMen = { startX + (btnW + gap), y, btnW, btnH };
-            Rectangle catKids = { startX, y + btnH + RH(0.04f), btnW, btnH };
-            Rectangle catMen = { startX, y, btnW, btnH };
-            Rectangle catWomen = { startX + (btnW + gap), y, btnW, btnH };
-            Rectangle catBaby = { startX + (btnW + gap), y + btnH + RH(0.04f), btnW, btnH };
-            if (DrawButton(catKids, "Kid", colors.buttonBg, colors, 28)) { selectedCategory = 1; productsLoaded = false; needsResort = true; state = STATE_VIEW_PRODUCTS; }
-            if (DrawButton(catMen, "Man", colors.buttonBg, colors, 28)) { selectedCategory = 2; productsLoaded = false; needsResort = true; state = STATE_VIEW_PRODUCTS; }
-            if (DrawButton(catWomen, "Women", colors.buttonBg, colors, 28)) { selectedCategory = 3; productsLoaded = false; needsResort = true; state = STATE_VIEW_PRODUCTS; }
-            if (DrawButton(catBaby, "Baby", colors.buttonBg, colors, 28)) { selectedCategory = 4; productsLoaded = false; needsResort = true; state = STATE_VIEW_PRODUCTS; }
+            const ChooserLayout &L = BuildChooserLayout();
+            DrawTextScaled("Choose a category", centerX - MeasureTextScaled("Choose a category", 28)/2, L.titleY, 28, colors.primary);
+            const Rectangle &catKids = L.bottomLeft;
+            const Rectangle &catMen = L.topLeft;
+            const Rectangle &catWomen = L.topRight;
+            const Rectangle &catBaby = L.bottomRight;
+            // Label each button with its result count; empty categories are dimmed
+            auto facetLabel = [](const char *name, int count) { return std::string(name) + " (" + std::to_string(count) + ")"; };
+            auto facetColor = [&](int count) { return count > 0 ? colors.buttonBg : Fade(colors.buttonBg, 0.4f); };
+            if (DrawButton(catKids, facetLabel("Kid", facets.category[1]).c_str(), facetColor(facets.category[1]), colors, 28)) { selectedCategory = 1; needsResort = true; state = STATE_VIEW_PRODUCTS; }
+            if (DrawButton(catMen, facetLabel("Man", facets.category[2]).c_str(), facetColor(facets.category[2]), colors, 28)) { selectedCategory = 2; needsResort = true; state = STATE_VIEW_PRODUCTS; }
+            if (DrawButton(catWomen, facetLabel("Women", facets.category[3]).c_str(), facetColor(facets.category[3]), colors, 28)) { selectedCategory = 3; needsResort = true; state = STATE_VIEW_PRODUCTS; }
+            if (DrawButton(catBaby, facetLabel("Baby", facets.category[4]).c_str(), facetColor(facets.category[4]), colors, 28)) { selectedCategory = 4; needsResort = true; state = STATE_VIEW_PRODUCTS; }
+            if (!searchInput.Empty()) {
+                std::string searchNote = std::string("Counts for search \"") + searchInput.Text() + "\"";
+                DrawTextScaled(searchNote.c_str(), centerX - MeasureTextScaled(searchNote.c_str(), 16)/2, L.noteY, 16, colors.accent);
+            }
 
-            float margin = 0.025f;
-            float btnWidth = RW(0.10f);
-            float btnHeight = RH(0.05f);
-            float squareSize = btnHeight;  // Make home button square
-            Rectangle backBtn = { (float)RX(margin), (float)RY(margin), btnWidth, btnHeight };
-            Rectangle homeBtn = { (float)(backBtn.x + backBtn.width + RW(0.01f)), (float)RY(margin), squareSize, squareSize };
-            if (DrawButton(backBtn, "< Back", colors.buttonBg, colors, 16)) state = STATE_VIEW_TYPE;
-            if (DrawButton(homeBtn, homeIcon, colors.buttonBg, colors)) state = STATE_MENU;
-        }
-        else if (state == STATE_VIEW_TYPE) {
-            // Choose type: Clothes (goes to category selector), Accessories or Shoes (go straight to list filtered)
-            DrawTextScaled("Choose view type", centerX - MeasureTextScaled("Choose view type", 28)/2, RY(0.12f), 28, colors.primary);
-            float btnW = RW(0.28f); float btnH = RH(0.10f); float gap = RW(0.03f);
-            float startX = centerX - (btnW*2 + gap)/2.0f;
-            float y = RY(0.28f);
-            Rectangle btnClothes = { startX, y, btnW, btnH };
-            Rectangle btnAccessories = { startX + (btnW + gap), y, btnW, btnH };
-            Rectangle btnShoes = { RX(0.5f)-(btnW/2), y + btnH + RH(0.04f), btnW, btnH };
-            if (DrawButton(btnClothes, "Clothes", colors.buttonBg, colors, 28)) { selectedProductGroup = 1; state = STATE_CATALOG; }
-            if (DrawButton(btnAccessories, "Accessories", colors.buttonBg, colors, 28)) { selectedProductGroup = 2; selectedCategory = 0; productsLoaded = false; needsResort = true; state = STATE_VIEW_PRODUCTS; }
-            if (DrawButton(btnShoes, "Shoes", colors.buttonBg, colors, 28)) { selectedProductGroup = 3; selectedCategory = 0; productsLoaded = false; needsResort = true; state = STATE_VIEW_PRODUCTS; }
+            if (DrawButton(L.backBtn, "< Back", colors.buttonBg, colors, 16)) state = STATE_VIEW_TYPE;
+            if (DrawButton(L.homeBtn, homeIcon, colors.buttonBg, colors)) state = STATE_MENU;
+        });
+        else if (state == STATE_VIEW_TYPE) DrawLayeredScreen([&]() {
+            // Keep the catalog loaded here too so the buttons can show live facet counts
+            if (!productsLoaded) productsLoaded = LoadProducts(productsPath);
+            if (needsResort) FilterAndSortProducts();
 
-            float margin = 0.025f;
-            float btnWidth = RW(0.10f);
-            float btnHeight = RH(0.05f);
-            float squareSize = btnHeight;  // Make home button square
-            Rectangle backBtn = { (float)RX(margin), (float)RY(margin), btnWidth, btnHeight };
-            Rectangle homeBtn = { (float)(backBtn.x + backBtn.width + RW(0.01f)), (float)RY(margin), squareSize, squareSize };
-            if (DrawButton(backBtn, "< Back", colors.buttonBg, colors, 16)) state = STATE_MENU;
-            if (DrawButton(homeBtn, homeIcon, colors.buttonBg, colors)) state = STATE_MENU;
-        }
+            // Choose type: Clothes (goes to category selector), Accessories or Shoes (go straight to list filtered)
+            const ChooserLayout &L = BuildChooserLayout();
+            DrawTextScaled("Choose view type", centerX - MeasureTextScaled("Choose view type", 28)/2, L.titleY, 28, colors.primary);
+            const Rectangle &btnClothes = L.topLeft;
+            const Rectangle &btnAccessories = L.topRight;
+            const Rectangle &btnShoes = L.bottomCenter;
+            auto facetLabel = [](const char *name, int count) { return std::string(name) + " (" + std::to_string(count) + ")"; };
+            auto facetColor = [&](int count) { return count > 0 ? colors.buttonBg : Fade(colors.buttonBg, 0.4f); };
+            if (DrawButton(btnClothes, facetLabel("Clothes", facets.group[1]).c_str(), facetColor(facets.group[1]), colors, 28)) { selectedProductGroup = 1; needsResort = true; state = STATE_CATALOG; }
+            if (DrawButton(btnAccessories, facetLabel("Accessories", facets.group[2]).c_str(), facetColor(facets.group[2]), colors, 28)) { selectedProductGroup = 2; selectedCategory = 0; needsResort = true; state = STATE_VIEW_PRODUCTS; }
+            if (DrawButton(btnShoes, facetLabel("Shoes", facets.group[3]).c_str(), facetColor(facets.group[3]), colors, 28)) { selectedProductGroup = 3; selectedCategory = 0; needsResort = true; state = STATE_VIEW_PRODUCTS; }
+
+            if (DrawButton(L.backBtn, "< Back", colors.buttonBg, colors, 16)) state = STATE_MENU;
+            if (DrawButton(L.homeBtn, homeIcon, colors.buttonBg, colors)) state = STATE_MENU;
+        });
         else if (state == STATE_VIEW_PRODUCTS) {
             // Load & sort once
-            if (!productsLoaded) { productsLoaded = LoadProducts("data/products.txt"); needsResort = true; }
+            if (!productsLoaded) { productsLoaded = LoadProducts(productsPath); needsResort = true; }
             if (needsResort) FilterAndSortProducts();
 
             // responsive layout for list
-            float margin = 0.025f;
-            float btnWidth = RW(0.10f);
-            float btnHeight = RH(0.05f);
-            float squareSize = btnHeight;  // Make home button square
-            Rectangle backBtn = { (float)RX(margin), (float)RY(margin), btnWidth, btnHeight };
-            Rectangle homeBtn = { (float)(backBtn.x + backBtn.width + RW(0.01f)), (float)RY(margin), squareSize, squareSize };
-            if (DrawButton(backBtn, "< Back", colors.buttonBg, colors, 16)) {
+            ProductListLayout &L = listLayout;
+            if (L.generation != layoutGeneration) {
+                float margin = 0.025f;
+                float btnHeight = RH(0.05f);
+                L.backBtn = { (float)RX(margin), (float)RY(margin), RW(0.10f), btnHeight };
+                L.homeBtn = { (float)(L.backBtn.x + L.backBtn.width + RW(0.01f)), (float)RY(margin), btnHeight, btnHeight }; // square
+                L.titleX = centerX - MeasureTextScaled("Product List", 40)/2;
+                L.titleY = (int)RY(0.05f);
+
+                // Toolbar: search and price range inputs on the left, sort buttons and facets on the right
+                L.labelX = (int)RX(0.025f);
+                L.searchLabelY = (int)RY(0.16f);
+                L.priceLabelY = (int)RY(0.225f);
+                L.searchRect = { (float)RX(0.12f), (float)RY(0.16f), (float)RW(0.30f), (float)RH(0.05f) };
+                L.minPriceRect = { (float)RX(0.12f), (float)RY(0.225f), (float)RW(0.08f), (float)RH(0.045f) };
+                L.maxPriceRect = { (float)RX(0.23f), (float)RY(0.225f), (float)RW(0.08f), (float)RH(0.045f) };
+                L.dashX = (int)(L.minPriceRect.x + L.minPriceRect.width + RW(0.01f));
+                float sortStartX = RX(0.45f);
+                float sortW = RW(0.12f); float sortH = RH(0.05f); float sortGap = RW(0.02f);
+                L.sortPriceBtn = { sortStartX, (float)RY(0.16f), sortW, sortH };
+                L.sortSizeBtn = { sortStartX + (sortW+sortGap)*1, (float)RY(0.16f), sortW, sortH };
+                L.sortChainBtn = { sortStartX + (sortW+sortGap)*2, (float)RY(0.16f), sortW*1.5f, sortH };
+                L.chipX = RX(0.36f) + MeasureTextScaled("Sizes:", 14) + RW(0.01f);
+                L.chipY = RY(0.217f);
+                L.chipH = RH(0.028f);
+                L.chipPad = RW(0.012f);
+                L.chipGap = RW(0.006f);
+                L.chipMaxX = sw - RW(0.02f);
+                L.noSizeMaxX = sw - RW(0.1f);
+                L.facetX = (int)RX(0.36f);
+                L.priceFacetY = (int)RY(0.250f);
+
+                // List rows and their columns
+                L.wheelStep = RH(0.05f);
+                L.keyStep = RH(0.01f);
+                L.rowH = (float)RH(0.05f);
+                L.startY = RY(0.30f);
+                L.listTop = RY(0.28f);
+                L.listBottom = RY(0.75f);
+                // With thumbnails on, a square image column sits left of the name
+                L.thumbX = RX(0.03f);
+                L.thumbSize = gThumbnails.enabled ? L.rowH * 0.85f : 0.0f;
+                L.nameX = RX(0.03f) + (gThumbnails.enabled ? L.thumbSize + RW(0.008f) : 0.0f);
+                L.priceX = RX(0.03f) + RW(0.25f); // price column starts after name
+                L.saleGap = RW(0.01f);
+                L.sizeX = RX(0.45f);
+                L.viewBtnX = (float)(sw - RW(0.18f));
+                L.viewBtnW = (float)RW(0.14f);
+                L.noProductsX = (int)RX(0.05f);
+                L.noProductsY = (int)RY(0.35f);
+                L.noMatchX = centerX - MeasureTextScaled("No products match your search criteria.", 18)/2;
+                L.noMatchY = (int)RY(0.40f);
+
+                // Description modal
+                float modalW = (float)RW(0.75f), modalH = (float)RH(0.55f);
+                L.modal = { (float)(centerX - modalW/2.0f), (float)RY(0.18f), modalW, modalH };
+                L.closeBtn = { (float)(L.modal.x + L.modal.width - (float)RW(0.12f)), (float)(L.modal.y + L.modal.height - (float)RH(0.08f)), (float)RW(0.12f), (float)RH(0.08f) };
+                L.addCartBtn = { L.modal.x + 20.0f, L.modal.y + L.modal.height - (float)RH(0.08f), (float)RW(0.22f), (float)RH(0.08f) };
+                float modalThumbSize = RH(0.18f);
+                L.modalThumb = { L.modal.x + L.modal.width - modalThumbSize - 20.0f, L.modal.y + 18.0f, modalThumbSize, modalThumbSize };
+                L.generation = layoutGeneration;
+            }
+            const Rectangle &searchRect = L.searchRect;
+            const Rectangle &minPriceRect = L.minPriceRect;
+            const Rectangle &maxPriceRect = L.maxPriceRect;
+            if (DrawButton(L.backBtn, "< Back", colors.buttonBg, colors, 16)) {
                 if (selectedProductGroup == 1) state = STATE_CATALOG; // clothes -> return to categories
                 else { state = STATE_VIEW_TYPE; selectedProductGroup = 0; } // others -> return to view-type menu
             }
-            if (DrawButton(homeBtn, homeIcon, colors.buttonBg, colors)) state = STATE_MENU;
+            if (DrawButton(L.homeBtn, homeIcon, colors.buttonBg, colors)) state = STATE_MENU;
 
             // Use Calibri for headings
-            DrawTextScaled("Product List", centerX - MeasureTextScaled("Product List", 40)/2, RY(0.05f), 40, DARKBLUE);
+            DrawTextScaled("Product List", L.titleX, L.titleY, 40, DARKBLUE);
 
             // Search area
-            DrawTextScaled("Search:", RX(0.025f), RY(0.16f), 18, colors.text);
-            Rectangle searchRect = { (float)RX(0.12f), (float)RY(0.16f), (float)RW(0.30f), (float)RH(0.05f) };
-            DrawRectangleRec(searchRect, LIGHTGRAY);
-            DrawTextScaled(searchInput, (int)searchRect.x + 6, (int)searchRect.y + 6, 18, BLACK);
-            if (searchActive) DrawRectangleLinesEx(searchRect, 2, BLUE);
-
-            Vector2 mouse = GetMousePosition();
-            if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) searchActive = CheckCollisionPointRec(mouse, searchRect);
-            if (searchActive) {
-                int key = GetCharPressed();
+            DrawTextScaled("Search:", L.labelX, L.searchLabelY, 18, colors.text);
+            gBackend->DrawRectangleRec(searchRect, LIGHTGRAY);
+            searchInput.Draw(searchRect, 18, BLACK, searchActive);
+            if (searchActive) gBackend->DrawRectangleLinesEx(searchRect, 2, BLUE);
+
+            // Price range inputs (second toolbar row)
+            DrawTextScaled("Price:", L.labelX, L.priceLabelY, 18, colors.text);
+            gBackend->DrawRectangleRec(minPriceRect, LIGHTGRAY);
+            gBackend->DrawRectangleRec(maxPriceRect, LIGHTGRAY);
+            DrawTextScaled(minPriceInput[0] ? minPriceInput : "min", (int)minPriceRect.x + 6, (int)minPriceRect.y + 5, 16, minPriceInput[0] ? BLACK : GRAY);
+            DrawTextScaled("-", L.dashX, (int)minPriceRect.y + 5, 16, colors.text);
+            DrawTextScaled(maxPriceInput[0] ? maxPriceInput : "max", (int)maxPriceRect.x + 6, (int)maxPriceRect.y + 5, 16, maxPriceInput[0] ? BLACK : GRAY);
+            if (priceInputFocus == 1) gBackend->DrawRectangleLinesEx(minPriceRect, 2, BLUE);
+            if (priceInputFocus == 2) gBackend->DrawRectangleLinesEx(maxPriceRect, 2, BLUE);
+
+            Vector2 mouse = gBackend->GetMousePosition();
+            if (gBackend->IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+                searchActive = CheckCollisionPointRec(mouse, searchRect);
+                if (CheckCollisionPointRec(mouse, minPriceRect)) priceInputFocus = 1;
+                else if (CheckCollisionPointRec(mouse, maxPriceRect)) priceInputFocus = 2;
+                else priceInputFocus = 0;
+            }
+            if (priceInputFocus != 0) {
+                char *buf = (priceInputFocus == 1) ? minPriceInput : maxPriceInput;
+                int key = gBackend->GetCharPressed();
                 while (key > 0) {
-                    if (key >= 32 && key <= 125 && strlen(searchInput) < 63) {
-                        int len = strlen(searchInput);
-                        searchInput[len] = (char)key; searchInput[len+1] = '\0'; needsResort = true;
+                    if (((key >= '0' && key <= '9') || key == '.') && strlen(buf) < 15) {
+                        int len = strlen(buf);
+                        buf[len] = (char)key; buf[len+1] = '\0'; needsResort = true;
                     }
-                    key = GetCharPressed();
+                    key = gBackend->GetCharPressed();
                 }
-                if (IsKeyPressed(KEY_BACKSPACE) && strlen(searchInput) > 0) {
-                    searchInput[strlen(searchInput)-1] = '\0'; needsResort = true;
+                if (gBackend->IsKeyPressed(KEY_BACKSPACE) && strlen(buf) > 0) {
+                    buf[strlen(buf)-1] = '\0'; needsResort = true;
                 }
             }
+            if (searchActive) {
+                searchInput.HandleMouse(searchRect, 18);
+                if (searchInput.HandleKeys()) needsResort = true;
+            }
 
             // Sorting buttons
-            float sortStartX = RX(0.45f);
-            float sortW = RW(0.12f); float sortH = RH(0.05f); float sortGap = RW(0.02f);
-            Rectangle sortPriceBtn = { sortStartX, (float)RY(0.16f), sortW*1.0f, sortH };
-            Rectangle sortSizeBtn = { sortStartX + (sortW+sortGap)*1, (float)RY(0.16f), sortW, sortH };
             Color sortBtnColor = colors.buttonBg;
             // Price toggle button: click alternates between Price ascending (1) and descending (2)
             const char *priceLabel = "Price";
             Color priceColor = sortBtnColor;
             if (sortMode == 1) { priceLabel = "Price ^"; priceColor = DARK_ACCENT; }
             else if (sortMode == 2) { priceLabel = "Price v"; priceColor = DARK_ACCENT; }
-            if (DrawButton(sortPriceBtn, priceLabel, priceColor, colors, 14)) {
+            if (DrawButton(L.sortPriceBtn, priceLabel, priceColor, colors, 14)) {
                 if (sortMode == 1) sortMode = 2;
                 else sortMode = 1;
                 needsResort = true;
@@ -1241,120 +3931,167 @@ int main() {
             Color sizeColor = sortBtnColor;
             if (sortMode == 3) { sizeLabel = "Size ^"; sizeColor = DARK_ACCENT; }
             else if (sortMode == 4) { sizeLabel = "Size v"; sizeColor = DARK_ACCENT; }
-            if (DrawButton(sortSizeBtn, sizeLabel, sizeColor, colors, 14)) {
+            if (DrawButton(L.sortSizeBtn, sizeLabel, sizeColor, colors, 14)) {
                 if (sortMode == 3) sortMode = 4;
                 else sortMode = 3;
                 needsResort = true;
             }
+            // Chain button: cycles through the multi-key chains (built-in + data/sort_chains.txt)
+            const char *chainLabel = "Sort...";
+            Color chainColor = sortBtnColor;
+            if (sortMode >= 5 && sortMode < (int)sortChains.size()) { chainLabel = sortChains[sortMode].label.c_str(); chainColor = DARK_ACCENT; }
+            if ((int)sortChains.size() > 5 && DrawButton(L.sortChainBtn, chainLabel, chainColor, colors, 14)) {
+                if (sortMode >= 5 && sortMode + 1 < (int)sortChains.size()) sortMode += 1;
+                else sortMode = 5;
+                needsResort = true;
+            }
 
-
-
+            // Facet counts for the current results: size chips (click to filter by size) and price buckets
+            {
+                float chipX = L.chipX;
+                DrawTextScaled("Sizes:", L.facetX, (int)L.chipY, 14, Fade(colors.text, 0.8f));
+                for (size_t si = 0; si < facets.size.size() && si < sizeChipLabels.size(); ++si) {
+                    if (facets.size[si] == 0 && (int)si != selectedSizeOrd) continue;
+                    const std::string &chipLabel = sizeChipLabels[si];
+                    float chipW = MeasureTextScaled(chipLabel.c_str(), 14) + L.chipPad;
+                    if (chipX + chipW > L.chipMaxX) break;
+                    Rectangle chip = { chipX, L.chipY, chipW, L.chipH };
+                    Color chipColor = ((int)si == selectedSizeOrd) ? DARK_ACCENT : colors.buttonBg;
+                    if (DrawButton(chip, chipLabel.c_str(), chipColor, colors, 14)) {
+                        selectedSizeOrd = ((int)si == selectedSizeOrd) ? -1 : (int)si;
+                        needsResort = true;
+                    }
+                    chipX += chipW + L.chipGap;
+                }
+                if (facets.noSize > 0 && chipX < L.noSizeMaxX) {
+                    DrawTextScaled(noSizeLabel.c_str(), (int)chipX, (int)L.chipY, 14, Fade(colors.text, 0.8f));
+                }
+                DrawTextScaled(priceFacetLine.c_str(), L.facetX, L.priceFacetY, 14, Fade(colors.text, 0.8f));
+            }
 
             // Scroll & list
-            float wheel = GetMouseWheelMove(); productsScroll -= wheel * RH(0.05f);
-            if (IsKeyDown(KEY_DOWN)) productsScroll -= RH(0.01f);
-            if (IsKeyDown(KEY_UP)) productsScroll += RH(0.01f);
-            float rowH = (float)RH(0.05f);
-            float contentH = (float)filteredProducts.size() * rowH;
-            float minScroll = std::min(0.0f, RY(0.78f) - contentH);
+            float wheel = gBackend->GetMouseWheelMove(); productsScroll -= wheel * L.wheelStep;
+            if (gBackend->IsKeyDown(KEY_DOWN)) productsScroll -= L.keyStep;
+            if (gBackend->IsKeyDown(KEY_UP)) productsScroll += L.keyStep;
+            float rowH = L.rowH;
+            double contentH = (double)filteredIndices.size() * rowH;
+            double minScroll = std::min(0.0, L.listBottom - contentH);
             if (productsScroll < minScroll) productsScroll = minScroll;
             if (productsScroll > 0) productsScroll = 0;
 
-            float startY = RY(0.27f);
+            float startY = L.startY;
             if (products.empty()) {
-                DrawTextScaled("No products found. Create 'data/products.txt' with one product per line (name;price).", RX(0.05f), RY(0.35f), 18, RED);
-            } else if (filteredProducts.empty()) {
-                DrawTextScaled("No products match your search criteria.", centerX - MeasureTextScaled("No products match your search criteria.", 18)/2, RY(0.40f), 18, ORANGE);
+                DrawTextScaled("No products found. Create 'data/products.txt' with one product per line (name;price).", L.noProductsX, L.noProductsY, 18, RED);
+            } else if (filteredIndices.empty()) {
+                DrawTextScaled("No products match your search criteria.", L.noMatchX, L.noMatchY, 18, ORANGE);
             } else {
                 static int viewDescriptionIndex = -1;
-                for (size_t i = 0; i < filteredProducts.size(); ++i) {
-                    float y = startY + i * rowH + productsScroll;
-                    if (y < RY(0.20f) - rowH || y > sh) continue;
-                    const auto &p = filteredProducts[i];
+                // Only walk the rows that can be on screen: the visible index range follows
+                // directly from the scroll offset, so cost per frame does not depend on list size
+                float listTop = L.listTop;
+                long firstRow = (long)std::ceil((listTop - startY - productsScroll) / rowH);
+                long lastRow = (long)std::floor(((double)sh - startY - productsScroll) / rowH);
+                size_t firstVisible = (size_t)std::max(0L, firstRow);
+                size_t endVisible = (size_t)std::min((long)filteredIndices.size(), std::max(0L, lastRow + 1));
+                auto productAt = [&](size_t row) -> const CatalogEntry & { return products[filteredIndices[row]]; };
+                BeginTextBatch(18); // row text is drawn after all row shapes, grouped by size
+                for (size_t i = firstVisible; i < endVisible; ++i) {
+                    float y = (float)(startY + (double)i * rowH + productsScroll); // large terms cancel in double
+                    if (y < listTop || y > sh) continue;
+                    const auto &p = products[filteredIndices[i]];
+                    CatalogRow &row = catalogPages.Get(viewVersion, i, filteredIndices.size(), productAt);
+                    if (gThumbnails.enabled) DrawThumbnail(row.name, Rectangle{ L.thumbX, y - rowH*0.15f, L.thumbSize, L.thumbSize }, Fade(colors.inputBg, 0.9f));
                     // Draw name
-                    DrawTextScaled(p.name.c_str(), RX(0.03f), (int)y, 20, colors.text);
+                    DrawTextScaled(row.name.c_str(), (int)L.nameX, (int)y, 20, colors.text);
                     
                     // Price column starts after name
-                    float priceX = RX(0.03f) + RW(0.25f);
+                    float priceX = L.priceX;
                     if (p.hasPrice) {
+                        ProductLabels &labels = row.labels;
                         if (p.hasSale) {
                             // Original price struck-through
-                            std::ostringstream ss; ss.setf(std::ios::fixed); ss.precision(2); ss << "$" << p.price;
-                            std::string orig = ss.str();
-                            int origW = MeasureTextScaled(orig.c_str(), 18);
+                            int origW = labels.price.Width(18);
                             Color faded = Fade(colors.text, 0.6f);
-                            DrawTextScaled(orig.c_str(), (int)priceX, (int)y, 18, faded);
+                            DrawTextScaled(labels.price.text.c_str(), (int)priceX, (int)y, 18, faded);
                             float lineY = (float)y + ScaledFontSize(18) * 0.5f;
-                            DrawLineEx(Vector2{ priceX, lineY }, Vector2{ priceX + origW, lineY }, 2.0f, colors.text);
+                            gBackend->DrawRectangleRec(Rectangle{ priceX, lineY - 1.0f, (float)origW, 2.0f }, colors.text); // quad, stays in the row batch
                             
                             // Sale price right after
-                            double salePrice = p.price * (1.0 - p.salePercent/100.0);
-                            std::ostringstream sps; sps.setf(std::ios::fixed); sps.precision(2); sps << "$" << salePrice;
-                            DrawTextScaled(sps.str().c_str(), (int)(priceX + origW + RW(0.01f)), (int)y, 18, colors.primary);
+                            DrawTextScaled(labels.sale.text.c_str(), (int)(priceX + origW + L.saleGap), (int)y, 18, colors.primary);
                         } else {
-                            std::ostringstream ss; ss.setf(std::ios::fixed); ss.precision(2); ss << "$" << p.price;
-                            DrawTextScaled(ss.str().c_str(), (int)priceX, (int)y, 18, colors.text);
+                            DrawTextScaled(labels.price.text.c_str(), (int)priceX, (int)y, 18, colors.text);
                         }
                     }
 
                     // Size column starts after price
-                    float sizeX = RX(0.45f); // Adjust this value to position size column
-                    if (!p.size.empty()) {
-                        DrawTextScaled(p.size.c_str(), (int)sizeX, (int)y, 16, Fade(colors.text, 0.8f));
+                    float sizeX = L.sizeX;
+                    if (!row.size.empty()) {
+                        DrawTextScaled(row.size.c_str(), (int)sizeX, (int)y, 16, Fade(colors.text, 0.8f));
                     }
 
                     // View button stays on the right
-                    Rectangle viewBtn = { (float)(sw - RW(0.18f)), y - rowH*0.15f, (float)RW(0.14f), (float)(rowH*0.85f) };
+                    Rectangle viewBtn = { L.viewBtnX, y - rowH*0.15f, L.viewBtnW, (float)(rowH*0.85f) };
                     if (DrawButton(viewBtn, "View", colors.buttonBg, colors, 14)) viewDescriptionIndex = (int)i;
                 }
 
-                if (viewDescriptionIndex >= 0 && viewDescriptionIndex < (int)filteredProducts.size()) {
-                    const auto &p = filteredProducts[viewDescriptionIndex];
-                    float modalW = (float)RW(0.75f), modalH = (float)RH(0.55f);
-                    Rectangle modal; modal.x = (float)(centerX - modalW/2.0f); modal.y = (float)RY(0.18f); modal.width = modalW; modal.height = modalH;
-                    DrawRectangleRec(modal, Fade(colors.inputBg, 0.98f)); DrawRectangleLinesEx(modal, 2, colors.accent);
-                    DrawTextScaled(p.name.c_str(), (int)modal.x + 20, (int)modal.y + 18, 24, colors.text);
+                EndTextBatch();
+
+                // Prefetch the next page in the direction the list is scrolling
+                static size_t prevFirstVisible = 0;
+                if (firstVisible > prevFirstVisible) catalogPages.Prefetch(viewVersion, endVisible + CatalogPages::kPageRows / 2, filteredIndices.size(), productAt);
+                else if (firstVisible < prevFirstVisible && firstVisible >= CatalogPages::kPageRows / 2)
+                    catalogPages.Prefetch(viewVersion, firstVisible - CatalogPages::kPageRows / 2, filteredIndices.size(), productAt);
+                prevFirstVisible = firstVisible;
+
+                if (viewDescriptionIndex >= 0 && viewDescriptionIndex < (int)filteredIndices.size()) {
+                    const CatalogRow &details = catalogPages.Get(viewVersion, (size_t)viewDescriptionIndex, filteredIndices.size(), productAt);
+                    const Rectangle &modal = L.modal;
+                    gBackend->DrawRectangleRec(modal, Fade(colors.inputBg, 0.98f)); gBackend->DrawRectangleLinesEx(modal, 2, colors.accent);
+                    DrawTextScaled(details.name.c_str(), (int)modal.x + 20, (int)modal.y + 18, 24, colors.text);
+                    if (gThumbnails.enabled) DrawThumbnail(details.name, L.modalThumb, Fade(colors.buttonBg, 0.5f));
 
                     // Show fabric and sex metadata if available
                     int metaY = (int)modal.y + 54;
-                    if (!p.fabric.empty()) {
-                        std::string fabricLine = std::string("description: ") + p.fabric;
+                    if (!details.fabric.empty()) {
+                        std::string fabricLine = std::string("description: ") + details.fabric;
                         DrawTextScaled(fabricLine.c_str(), (int)modal.x + 20, metaY, 18, colors.text);
                         metaY += 22;
                     }
-                    if (!p.sex.empty()) {
-                        std::string sexLine = std::string("For: ") + p.sex;
+                    if (!details.sex.empty()) {
+                        std::string sexLine = std::string("For: ") + details.sex;
                         DrawTextScaled(sexLine.c_str(), (int)modal.x + 20, metaY, 18, colors.text);
                         metaY += 2;
                     }
 
-                    std::string desc = p.description.empty() ? "" : p.description;
                     int descY = metaY + 6;
-                    int maxWidth = (int)modal.width - 40;
-                    std::istringstream iss(desc);
-                    std::string word;
-                    std::string lineBuf;
-                    while (iss >> word) {
-                        std::string tryLine = lineBuf.empty() ? word : (lineBuf + " " + word);
-                        if (MeasureTextScaled(tryLine.c_str(), 18) > maxWidth) { DrawTextScaled(lineBuf.c_str(), (int)modal.x + 20, descY, 18, colors.text); descY += 22; lineBuf = word; }
-                        else lineBuf = tryLine;
+                    int maxWidth = (int)modal.width - 40 - (gThumbnails.enabled ? (int)L.modalThumb.width + 20 : 0);
+                    int productIndex = filteredIndices[viewDescriptionIndex];
+                    if (descLayout.productIndex != productIndex || descLayout.version != catalogVersion ||
+                        descLayout.maxWidth != maxWidth || descLayout.fontPx != ScaledFontSize(18)) {
+                        descLayout.lines = WrapTextLines(details.description, 18, maxWidth);
+                        descLayout.productIndex = productIndex;
+                        descLayout.version = catalogVersion;
+                        descLayout.maxWidth = maxWidth;
+                        descLayout.fontPx = ScaledFontSize(18);
                     }
-                    if (!lineBuf.empty()) DrawTextScaled(lineBuf.c_str(), (int)modal.x + 20, descY, 18, colors.text);
-                    Rectangle closeBtn; closeBtn.x = (float)(modal.x + modal.width - (float)RW(0.12f)); closeBtn.y = (float)(modal.y + modal.height - (float)RH(0.08f)); closeBtn.width = (float)RW(0.12f); closeBtn.height = (float)RH(0.08f);
-                    if (DrawButton(closeBtn, "Close", colors.buttonBg, colors, 16)) viewDescriptionIndex = -1;
+                    for (const auto &line : descLayout.lines) {
+                        if (descY > sh) break; // rest of a long description is off screen
+                        DrawTextScaled(line.c_str(), (int)modal.x + 20, descY, 18, colors.text);
+                        descY += 22;
+                    }
+                    if (DrawButton(L.closeBtn, "Close", colors.buttonBg, colors, 16)) viewDescriptionIndex = -1;
                     // Add to cart button (logged-in users)
                     if (!currentUser.empty()) {
-                        Rectangle addCartBtn = { modal.x + 20.0f, modal.y + modal.height - (float)RH(0.08f), (float)RW(0.22f), (float)RH(0.08f) };
-                        if (DrawButton(addCartBtn, "Add to Cart", colors.primary, colors, 16)) {
+                        if (DrawButton(L.addCartBtn, "Add to Cart", colors.primary, colors, 16)) {
                             // add or increment
                             bool found = false;
                             for (auto &it : currentCart) {
-                                if (it.first == p.name) { it.second += 1; found = true; break; }
+                                if (it.first == details.name) { it.second += 1; found = true; break; }
                             }
-                            if (!found) currentCart.push_back({p.name, 1});
+                            if (!found) currentCart.push_back({details.name, 1});
                             SaveCart(currentUser, currentCart);
                             // show temporary popup notification
-                            cartPopupMsg = std::string("Added '") + p.name + "' to cart";
+                            cartPopupMsg = std::string("Added '") + details.name + "' to cart";
                             cartPopupTimer = cartPopupDur;
                         }
                     }
@@ -1362,123 +4099,153 @@ int main() {
             }
         }
         else if (state == STATE_ADD_PRODUCT) {
-            // Back button
-            float margin = 0.025f;
-            float btnWidth = RW(0.10f);
-            float btnHeight = RH(0.05f);
-            float squareSize = btnHeight;  // Make home button square
-            Rectangle backBtn = { (float)RX(margin), (float)RY(margin), btnWidth, btnHeight };
-            Rectangle homeBtn = { (float)(backBtn.x + backBtn.width + RW(0.01f)), (float)RY(margin), squareSize, squareSize };
-            if (DrawButton(backBtn, "< Back", colors.buttonBg, colors, 16)) state = STATE_EDIT_PRODUCTS;
-            if (DrawButton(homeBtn, homeIcon, colors.buttonBg, colors)) state = STATE_MENU;
-
-            // Quick link to Edit Products
-            Rectangle editProductsBtn = { (float)(sw - RW(0.18f)), (float)RY(0.025f), (float)RW(0.16f), (float)RH(0.05f) };
-            if (DrawButton(editProductsBtn, "Edit Products", colors.buttonBg, colors, 14)) state = STATE_EDIT_PRODUCTS;
-            DrawTextScaled("Add Product", centerX - MeasureTextScaled("Add Product", 40)/2, RY(0.05f), 40, colors.primary);
-
-            if (currentUser.empty() || !isAdmin) {
-                DrawTextScaled("Admin privileges required to add products.", centerX - MeasureTextScaled("Admin privileges required to add products.", 20)/2, RY(0.20f), 20, colors.accent);
-                DrawTextScaled("Please login with an admin account.", centerX - MeasureTextScaled("Please login with an admin account.", 18)/2, RY(0.26f), 18, colors.text);
-                Rectangle btnToLogin; btnToLogin.x = (float)(centerX - (float)RW(0.15f)); btnToLogin.y = (float)RY(0.36f); btnToLogin.width = (float)RW(0.30f); btnToLogin.height = (float)RH(0.08f);
-                if (DrawButton(btnToLogin, "Go to Login", colors.buttonBg, colors, 20)) { memset(username,0,sizeof(username)); memset(password,0,sizeof(password)); state = STATE_LOGIN; }
-            } else {
-                // Responsive, centered Add Product form
-                static std::string nameInput, priceInput, sizeInput, removeInput, saleInput, msg;
-                static int activeFieldAdd = 0; // 0=name,1=price,2=remove,3=sale
-                static int editingIndex = -1; // index in products when editing, -1 = new
-                static int selectedProductType = 0; // 0=none, 1=Clothes, 2=Shoes, 3=Accessories
-                static int selectedCategoryAdd = 0; // 0=none,1=M,2=W,3=K,4=B
-
-                // Layout metrics
+            AddProductLayout &L = addProductLayout;
+            if (L.generation != layoutGeneration) {
+                // Back button
+                float margin = 0.025f;
+                float btnWidth = RW(0.10f);
+                float btnHeight = RH(0.05f);
+                float squareSize = btnHeight;  // Make home button square
+                L.backBtn = { (float)RX(margin), (float)RY(margin), btnWidth, btnHeight };
+                L.homeBtn = { (float)(L.backBtn.x + L.backBtn.width + RW(0.01f)), (float)RY(margin), squareSize, squareSize };
+                // Quick link to Edit Products
+                L.editProductsBtn = { (float)(sw - RW(0.18f)), (float)RY(0.025f), (float)RW(0.16f), (float)RH(0.05f) };
+                L.titleX = centerX - MeasureTextScaled("Add Product", 40)/2;
+                L.titleY = (int)RY(0.05f);
+                L.adminNoteX = centerX - MeasureTextScaled("Admin privileges required to add products.", 20)/2;
+                L.adminNoteY = (int)RY(0.20f);
+                L.loginNoteX = centerX - MeasureTextScaled("Please login with an admin account.", 18)/2;
+                L.loginNoteY = (int)RY(0.26f);
+                L.btnToLogin.x = (float)(centerX - (float)RW(0.15f)); L.btnToLogin.y = (float)RY(0.36f); L.btnToLogin.width = (float)RW(0.30f); L.btnToLogin.height = (float)RH(0.08f);
+
+                // Form metrics
                 float topY = RY(0.10f);
-                float labelX = RX(0.12f);
+                L.labelX = RX(0.12f);
                 float inputX = RX(0.30f);
                 float fullW = RW(0.58f);
                 float inputH = RH(0.06f);
                 float gapV = RH(0.035f);
 
-                Rectangle nameRect = { inputX, topY, fullW, inputH };
-                Rectangle priceRect = { inputX, nameRect.y + inputH + gapV, fullW * 0.4f, inputH };
+                L.nameRect = { inputX, topY, fullW, inputH };
+                L.priceRect = { inputX, L.nameRect.y + inputH + gapV, fullW * 0.4f, inputH };
                 // Category buttons will sit to the right of the price input
-                float catX = priceRect.x + priceRect.width + RW(0.02f);
+                float catX = L.priceRect.x + L.priceRect.width + RW(0.02f);
                 float catBtnW = RW(0.06f);
                 float catBtnH = inputH * 0.9f;
                 float catGap = RW(0.015f);
                 // reserve remaining width for category buttons area (not used as a rect here)
                 float extraVerticalOffset = RH(0.08f); // adjust this value to move further up/down
-                Rectangle sizeAreaRect = { inputX, priceRect.y + inputH + gapV + extraVerticalOffset, fullW, inputH };
-                float descY = sizeAreaRect.y + inputH + gapV * 1.2f;
+                L.sizeAreaRect = { inputX, L.priceRect.y + inputH + gapV + extraVerticalOffset, fullW, inputH };
+                float descY = L.sizeAreaRect.y + inputH + gapV * 1.2f;
                 float descH_add = (float)RH(0.18f);
                 Rectangle descRect; descRect.x = inputX; descRect.y = descY; descRect.width = fullW; descRect.height = descH_add;
 
+                // Product type buttons (Clothes/Shoes/Accessories) right of the price input
+                float typeX = L.priceRect.x + L.priceRect.width + RW(0.02f);
+                float typeBtnW = RW(0.08f);
+                float typeBtnH = inputH * 0.9f;
+                float typeGap = RW(0.015f);
+                for (size_t ti = 0; ti < 3; ++ti) L.typeBtns[ti] = { typeX + ti * (typeBtnW + typeGap), L.priceRect.y, typeBtnW, typeBtnH };
+                // Sex category buttons (M/W/K/B) below them
+                float catY = L.priceRect.y + L.priceRect.height + RH(0.02f);
+                for (size_t ci = 0; ci < 4; ++ci) L.catBtns[ci] = { typeX + ci * (catBtnW + catGap), catY, catBtnW, catBtnH };
+                L.saleRect = { inputX, L.priceRect.y + L.priceRect.height + RH(0.03f), fullW * 0.2f, inputH };
+
+                // Size buttons centered inside sizeAreaRect
+                float sbtnW = RW(0.09f), sbtnH = inputH * 0.9f, sGap = RW(0.02f);
+                float totalS = sbtnW * 6.0f + sGap * (6.0f - 1.0f);
+                float startSx = inputX + (fullW - totalS) / 2.0f;
+                float sBtnsY = L.sizeAreaRect.y + (L.sizeAreaRect.height - sbtnH) / 2.0f;
+                for (size_t si = 0; si < 6; ++si) L.sizeBtns[si] = { startSx + si * (sbtnW + sGap), sBtnsY, sbtnW, sbtnH };
+
+                // Action buttons centered (Save, Cancel)
+                float actionY = L.sizeAreaRect.y + inputH + gapV;
+                float actionW = RW(0.22f), actionH = RH(0.08f), actionGap = RW(0.04f);
+                float totalActionW = actionW * 2 + actionGap;
+                float actionStartX = centerX - totalActionW / 2.0f;
+                L.btnSave = { actionStartX, actionY, actionW, actionH };
+                L.btnCancel = { actionStartX + actionW + actionGap, actionY, actionW, actionH };
+                L.msgY = (int)RY(0.86f);
+                L.generation = layoutGeneration;
+            }
+            if (DrawButton(L.backBtn, "< Back", colors.buttonBg, colors, 16)) state = STATE_EDIT_PRODUCTS;
+            if (DrawButton(L.homeBtn, homeIcon, colors.buttonBg, colors)) state = STATE_MENU;
+
+            if (DrawButton(L.editProductsBtn, "Edit Products", colors.buttonBg, colors, 14)) state = STATE_EDIT_PRODUCTS;
+            DrawTextScaled("Add Product", L.titleX, L.titleY, 40, colors.primary);
+
+            if (currentUser.empty() || !isAdmin) {
+                DrawTextScaled("Admin privileges required to add products.", L.adminNoteX, L.adminNoteY, 20, colors.accent);
+                DrawTextScaled("Please login with an admin account.", L.loginNoteX, L.loginNoteY, 18, colors.text);
+                if (DrawButton(L.btnToLogin, "Go to Login", colors.buttonBg, colors, 20)) { username.Clear(); password.Clear(); state = STATE_LOGIN; }
+            } else {
+                // Responsive, centered Add Product form
+                static std::string nameInput, priceInput, sizeInput, removeInput, saleInput, msg;
+                static int activeFieldAdd = 0; // 0=name,1=price,2=remove,3=sale
+                static int editingIndex = -1; // index in products when editing, -1 = new
+                static int selectedProductType = 0; // 0=none, 1=Clothes, 2=Shoes, 3=Accessories
+                static int selectedCategoryAdd = 0; // 0=none,1=M,2=W,3=K,4=B
+
+                const float labelX = L.labelX;
+                const Rectangle &nameRect = L.nameRect;
+                const Rectangle &priceRect = L.priceRect;
+                const Rectangle &sizeAreaRect = L.sizeAreaRect;
+
                 // Draw labels and inputs
                 DrawTextScaled("Name:", labelX, (int)nameRect.y + 6, 24, colors.text);
-                DrawRectangleRec(nameRect, colors.inputBg);
+                gBackend->DrawRectangleRec(nameRect, colors.inputBg);
                 DrawTextScaled(nameInput.c_str(), (int)nameRect.x + 8, (int)nameRect.y + 6, 18, colors.text);
-                if (activeFieldAdd == 0) DrawRectangleLinesEx(nameRect, 2, colors.accent);
+                if (activeFieldAdd == 0) gBackend->DrawRectangleLinesEx(nameRect, 2, colors.accent);
 
                 DrawTextScaled("Price:", labelX, (int)priceRect.y + 6, 24, colors.text);
-                DrawRectangleRec(priceRect, colors.inputBg);
+                gBackend->DrawRectangleRec(priceRect, colors.inputBg);
                 DrawTextScaled(priceInput.c_str(), (int)priceRect.x + 8, (int)priceRect.y + 6, 18, colors.text);
-                if (activeFieldAdd == 1) DrawRectangleLinesEx(priceRect, 2, colors.accent);
-                // Then add this code after the price input and before the sex category buttons:
+                if (activeFieldAdd == 1) gBackend->DrawRectangleLinesEx(priceRect, 2, colors.accent);
                 // Product type selection (Clothes/Shoes/Accessories)
-                float typeX = priceRect.x + priceRect.width + RW(0.02f);
-                float typeBtnW = RW(0.08f);
-                float typeBtnH = inputH * 0.9f;
-                float typeGap = RW(0.015f);
-                
-                const std::vector<std::string> typeLabels = {"Clothes", "Shoes", "Access."};
-                for (size_t ti = 0; ti < typeLabels.size(); ++ti) {
-                    Rectangle tb = { typeX + ti * (typeBtnW + typeGap), priceRect.y, typeBtnW, typeBtnH };
-                    if (DrawButton(tb, typeLabels[ti].c_str(), colors.buttonBg, colors, 16)) {
+                static const char *const typeLabels[] = {"Clothes", "Shoes", "Access."};
+                for (size_t ti = 0; ti < 3; ++ti) {
+                    const Rectangle &tb = L.typeBtns[ti];
+                    if (DrawButton(tb, typeLabels[ti], colors.buttonBg, colors, 16)) {
                         selectedProductType = (int)ti + 1;
                         // Reset sex category when changing type
                         if (selectedProductType != 1) selectedCategoryAdd = 0;
                     }
-                    if (selectedProductType == (int)ti + 1) DrawRectangleLinesEx(tb, 3, colors.accent);
+                    if (selectedProductType == (int)ti + 1) gBackend->DrawRectangleLinesEx(tb, 3, colors.accent);
                 }
 
                 // Only show sex category buttons if Clothes is selected
                 if (selectedProductType == 1) {
                     // Category selection (M/W/K/B)
-                    const std::vector<std::string> catLabels = {"M","W","K","B"};
-                    float catY = priceRect.y + priceRect.height + RH(0.02f);
-                    for (size_t ci = 0; ci < catLabels.size(); ++ci) {
-                        Rectangle cb = { typeX + ci * (catBtnW + catGap), catY, catBtnW, catBtnH };
-                        if (DrawButton(cb, catLabels[ci].c_str(), colors.buttonBg, colors, 18)) 
+                    static const char *const catLabels[] = {"M","W","K","B"};
+                    for (size_t ci = 0; ci < 4; ++ci) {
+                        const Rectangle &cb = L.catBtns[ci];
+                        if (DrawButton(cb, catLabels[ci], colors.buttonBg, colors, 18)) 
                             selectedCategoryAdd = (int)ci + 1;
                         if (selectedCategoryAdd == (int)ci + 1) 
-                            DrawRectangleLinesEx(cb, 3, colors.accent);
+                            gBackend->DrawRectangleLinesEx(cb, 3, colors.accent);
 
                     }
                 }
                 // Sale % input moved below category buttons
-                float saleY = priceRect.y + priceRect.height + RH(0.03f);
-                Rectangle saleRect = { inputX, saleY, fullW * 0.2f, inputH };
+                const Rectangle &saleRect = L.saleRect;
                 DrawTextScaled("Sale %:", labelX, (int)saleRect.y , 20, colors.text);
-                DrawRectangleRec(saleRect, colors.inputBg);
+                gBackend->DrawRectangleRec(saleRect, colors.inputBg);
                 DrawTextScaled(saleInput.c_str(), (int)saleRect.x + 8, (int)saleRect.y + 6, 18, colors.text);
-                if (activeFieldAdd == 3) DrawRectangleLinesEx(saleRect, 2, colors.accent);
+                if (activeFieldAdd == 3) gBackend->DrawRectangleLinesEx(saleRect, 2, colors.accent);
 
                 // Size selection — buttons centered inside sizeAreaRect
                 DrawTextScaled("Size:", labelX, (int)sizeAreaRect.y + 6, 24, colors.text);
                 static const std::vector<std::string> sizeOptions = {"XS","S","M","L","XL","XXL"};
-                float sbtnW = RW(0.09f), sbtnH = inputH * 0.9f, sGap = RW(0.02f);
-                float totalS = sbtnW * (float)sizeOptions.size() + sGap * ((float)sizeOptions.size() - 1.0f);
-                float startSx = inputX + (fullW - totalS) / 2.0f;
-                float sBtnsY = sizeAreaRect.y + (sizeAreaRect.height - sbtnH) / 2.0f;
-                Vector2 mouse = GetMousePosition();
+                Vector2 mouse = gBackend->GetMousePosition();
                 for (size_t si = 0; si < sizeOptions.size(); ++si) {
-                    Rectangle sb = { startSx + si * (sbtnW + sGap), sBtnsY, sbtnW, sbtnH };
+                    const Rectangle &sb = L.sizeBtns[si];
                     if (DrawButton(sb, sizeOptions[si].c_str(), colors.buttonBg, colors, 18)) { sizeInput = sizeOptions[si]; }
-                    if (!sizeInput.empty() && sizeInput == sizeOptions[si]) DrawRectangleLinesEx(sb, 2, colors.accent);
+                    if (!sizeInput.empty() && sizeInput == sizeOptions[si]) gBackend->DrawRectangleLinesEx(sb, 2, colors.accent);
                 }
 
 
                 // Click-to-focus
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+                if (gBackend->IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
                     if (CheckCollisionPointRec(mouse, nameRect)) activeFieldAdd = 0;
                     else if (CheckCollisionPointRec(mouse, priceRect)) activeFieldAdd = 1;
                     else if (CheckCollisionPointRec(mouse, saleRect)) activeFieldAdd = 3;
@@ -1486,7 +4253,7 @@ int main() {
                 }
 
                 // Keyboard input for active field
-                int cp = GetCharPressed();
+                int cp = gBackend->GetCharPressed();
                 while (cp > 0) {
                     if (cp >= 32 && cp <= 125) {
                         if (activeFieldAdd == 0 && nameInput.size() < 200) nameInput.push_back((char)cp);
@@ -1494,25 +4261,18 @@ int main() {
                         else if (activeFieldAdd == 2 && removeInput.size() < 200) removeInput.push_back((char)cp);
                         else if (activeFieldAdd == 3 && saleInput.size() < 10) saleInput.push_back((char)cp);
                     }
-                    cp = GetCharPressed();
+                    cp = gBackend->GetCharPressed();
                 }
-                if (IsKeyPressed(KEY_BACKSPACE)) {
+                if (gBackend->IsKeyPressed(KEY_BACKSPACE)) {
                     if (activeFieldAdd == 0 && !nameInput.empty()) nameInput.pop_back();
                     else if (activeFieldAdd == 1 && !priceInput.empty()) priceInput.pop_back();
                     else if (activeFieldAdd == 2 && !removeInput.empty()) removeInput.pop_back();
                     else if (activeFieldAdd == 3 && !saleInput.empty()) saleInput.pop_back();
                 }
-                if (IsKeyPressed(KEY_TAB)) activeFieldAdd = (activeFieldAdd + 1) % 4;
+                if (gBackend->IsKeyPressed(KEY_TAB)) activeFieldAdd = (activeFieldAdd + 1) % 4;
 
                 // Action buttons centered (Save, Cancel)
-                float actionY = sizeAreaRect.y + inputH + gapV;
-                float actionW = RW(0.22f), actionH = RH(0.08f), actionGap = RW(0.04f);
-                float totalActionW = actionW * 2 + actionGap;
-                float actionStartX = centerX - totalActionW / 2.0f;
-                Rectangle btnSave = { actionStartX, actionY, actionW, actionH };
-                Rectangle btnCancel = { actionStartX + actionW + actionGap, actionY, actionW, actionH };
-
-                if (DrawButton(btnSave, "Save", colors.primary, colors, 20)) {
+                if (DrawButton(L.btnSave, "Save", colors.primary, colors, 20)) {
                     double pr = 0.0; bool ok = false;
                     try {
                         size_t start = 0; while (start < priceInput.size() && !((priceInput[start] >= '0' && priceInput[start] <= '9') || priceInput[start] == '.' || priceInput[start] == '-')) start++;
@@ -1543,7 +4303,8 @@ int main() {
 
                         if (editingIndex >= 0) {
                             // update existing by index (same logic)...
-                            std::ifstream ifs("data/products.txt");
+                            ProfileScope io(PROF_FILE_IO);
+                            std::ifstream ifs(productsPath);
                             if (!ifs) { msg = "Failed to open products file for update"; }
                             else {
                                 std::vector<std::string> lines; std::string line;
@@ -1553,7 +4314,7 @@ int main() {
                                 if (editingIndex >= 0 && editingIndex < (int)products.size()) fileIdx = products[editingIndex].fileIndex;
                                 if (fileIdx >= 0 && fileIdx < (int)lines.size()) {
                                     lines[fileIdx] = newline.str();
-                                    std::ofstream ofs("data/products.txt", std::ios::trunc);
+                                    std::ofstream ofs(productsPath, std::ios::trunc);
                                     if (!ofs) { msg = "Failed to write products file"; }
                                     else {
                                         for (auto &l : lines) ofs << l << "\n";
@@ -1567,7 +4328,8 @@ int main() {
                                 }
                             }
                         } else {
-                            std::ofstream ofs("data/products.txt", std::ios::app);
+                            ProfileScope io(PROF_FILE_IO);
+                            std::ofstream ofs(productsPath, std::ios::app);
                             if (ofs) {
                                 ofs << newline.str() << "\n";
                                 ofs.close();
@@ -1579,250 +4341,405 @@ int main() {
 
                 // (Remove button intentionally removed from Add Product screen)
 
-                if (DrawButton(btnCancel, "Cancel", colors.buttonBg, colors, 20)) state = STATE_MENU;
-                if (!msg.empty()) DrawTextScaled(msg.c_str(), centerX - MeasureTextScaled(msg.c_str(), 18)/2, RY(0.86f), 18, colors.accent);
+                if (DrawButton(L.btnCancel, "Cancel", colors.buttonBg, colors, 20)) state = STATE_MENU;
+                if (!msg.empty()) DrawTextScaled(msg.c_str(), centerX - MeasureTextScaled(msg.c_str(), 18)/2, L.msgY, 18, colors.accent);
             }
         }
         else if (state == STATE_CART) {
             // Ensure products loaded for price lookup
-            if (!productsLoaded) { productsLoaded = LoadProducts("data/products.txt"); needsResort = true; }
+            if (!productsLoaded) { productsLoaded = LoadProducts(productsPath); needsResort = true; }
 
-            // Back button
-            float margin = 0.025f;
-            float btnWidth = RW(0.10f);
-            float btnHeight = RH(0.05f);
-            float squareSize = btnHeight;  // Make home button square
-            Rectangle backBtn = { (float)RX(margin), (float)RY(margin), btnWidth, btnHeight };
-            Rectangle homeBtn = { (float)(backBtn.x + backBtn.width + RW(0.01f)), (float)RY(margin), squareSize, squareSize };
-            if (DrawButton(backBtn, "< Back", colors.buttonBg, colors, 16)) state = STATE_MENU;
-            if (DrawButton(homeBtn, homeIcon, colors.buttonBg, colors)) state = STATE_MENU;
-
-            std::string totStr = "";
-            if (currentUser.empty()) {
+            CartLayout &L = cartLayout;
+            if (L.generation != layoutGeneration) {
+                // Back button
+                float margin = 0.025f;
+                float btnWidth = RW(0.10f);
+                float btnHeight = RH(0.05f);
+                float squareSize = btnHeight;  // Make home button square
+                L.backBtn = { (float)RX(margin), (float)RY(margin), btnWidth, btnHeight };
+                L.homeBtn = { (float)(L.backBtn.x + L.backBtn.width + RW(0.01f)), (float)RY(margin), squareSize, squareSize };
                 // draw empty state lower to avoid overlapping header
-                DrawTextScaled("Please login to view your cart.", centerX - MeasureTextScaled("Please login to view your cart.", 18)/2, RY(0.30f), 18, colors.accent);
-            } else {
+                L.loginNoteX = centerX - MeasureTextScaled("Please login to view your cart.", 18)/2;
+                L.loginNoteY = (int)RY(0.30f);
+
                 // Layout columns (shifted slightly down so header stays visible)
                 float marginX = RX(0.06f);
                 // Card width is slightly smaller than full available width to leave room for the Remove button
-                float cardW = RW(0.78f);
-                float listX = marginX;
-                float listY = RY(0.20f); // moved down a bit
+                L.cardW = RW(0.78f);
+                L.listX = marginX;
+                L.listY = RY(0.20f); // moved down a bit
                 // internal column widths relative to card width
-                float colNameW = cardW * 0.55f;
-                float colQtyW = cardW * 0.15f;
-                float colPriceW = cardW * 0.15f;
-                float colSubW = cardW * 0.15f;
-                float rowH = RH(0.09f);
-                float gap = RH(0.015f);
+                L.colNameW = L.cardW * 0.55f;
+                L.colQtyW = L.cardW * 0.15f;
+                L.colPriceW = L.cardW * 0.15f;
+                float colSubW = L.cardW * 0.15f;
+                L.rowH = RH(0.09f);
+                L.gap = RH(0.015f);
+                L.headerRect = { L.listX, L.listY - L.rowH*0.9f, RW(0.88f), L.rowH*0.7f };
+                L.saleGap = RW(0.005f);
+                L.remBtnGap = RW(0.02f);
+                L.remBtnW = RW(0.12f);
+
+                L.emptyX = centerX - MeasureTextScaled("Your cart is empty.", 20)/2;
+                L.emptyY = (int)RY(0.45f);
+                L.emptyHintX = centerX - MeasureTextScaled("Browse products and click 'Add to Cart' to add items.", 16)/2;
+                L.emptyHintY = (int)RY(0.50f);
+                L.titleX = centerX - MeasureTextScaled("My Cart", 36)/2;
+                L.titleY = (int)RY(0.06f);
+                L.totBox = { (float)(centerX + RW(0.10f)), (float)RY(0.70f), (float)RW(0.34f), (float)RH(0.18f) };
+                // Checkout and Clear buttons inside the totals box
+                L.checkoutBtn = { L.totBox.x + 12, L.totBox.y + L.totBox.height - RH(0.06f) - 8, L.totBox.width - 24, RH(0.06f) };
+                L.clearBtn = { L.totBox.x + 12, L.totBox.y + L.totBox.height - RH(0.06f)*2 - 16, L.totBox.width - 24, RH(0.06f) };
+                L.generation = layoutGeneration;
+            }
+            if (DrawButton(L.backBtn, "< Back", colors.buttonBg, colors, 16)) state = STATE_MENU;
+            if (DrawButton(L.homeBtn, homeIcon, colors.buttonBg, colors)) state = STATE_MENU;
+
+            if (currentUser.empty()) {
+                DrawTextScaled("Please login to view your cart.", L.loginNoteX, L.loginNoteY, 18, colors.accent);
+            } else {
+                const float listX = L.listX, listY = L.listY, cardW = L.cardW;
+                const float colNameW = L.colNameW, colQtyW = L.colQtyW, colPriceW = L.colPriceW;
+                const float rowH = L.rowH, gap = L.gap;
 
                 // Header row background
-                Rectangle headerRect = { listX, listY - rowH*0.9f, RW(0.88f), rowH*0.7f };
-                DrawRectangleRec(headerRect, Fade(colors.inputBg, 0.95f));
+                const Rectangle &headerRect = L.headerRect;
+                gBackend->DrawRectangleRec(headerRect, Fade(colors.inputBg, 0.95f));
                 DrawTextScaled("Item", (int)listX + 8, (int)(headerRect.y + 6), 18, colors.text);
                 DrawTextScaled("Qty", (int)(listX + colNameW + 6), (int)(headerRect.y + 6), 18, colors.text);
                 DrawTextScaled("Price", (int)(listX + colNameW + colQtyW + 6), (int)(headerRect.y + 6), 18, colors.text);
                 DrawTextScaled("Subtotal", (int)(listX + colNameW + colQtyW + colPriceW + 6), (int)(headerRect.y + 6), 18, colors.text);
 
-                double total = 0.0;
+                // (Re)build the cached row strings when the cart or the catalog changed
+                if (cartRowsCartVersion != cartVersion || cartRowsCatalogVersion != catalogVersion) {
+                    cartRows.clear();
+                    double total = 0.0;
+                    for (const auto &it : currentCart) {
+                        CartRowLabels row;
+                        row.productIndex = FindProductByName(it.first);
+                        row.qty.text = std::to_string(it.second);
+                        const CatalogEntry *prod = row.productIndex >= 0 ? &products[row.productIndex] : nullptr;
+                        if (prod && prod->hasPrice) {
+                            double price = EffectivePrice(*prod);
+                            row.price.text = FormatMoney(price, "");
+                            row.subtotal.text = FormatMoney(price * it.second);
+                            row.product.price.text = FormatMoney(prod->price);
+                            if (prod->hasSale) row.product.sale.text = FormatMoney(price);
+                            total += price * it.second;
+                        } else {
+                            row.price.text = "-";
+                            row.subtotal.text = "-";
+                        }
+                        cartRows.push_back(row);
+                    }
+                    cartTotalLabel.text = FormatMoney(total, "Total: $");
+                    cartRowsCartVersion = cartVersion;
+                    cartRowsCatalogVersion = catalogVersion;
+                }
+
                 float y = listY;
                 if (currentCart.empty()) {
-                    DrawTextScaled("Your cart is empty.", centerX - MeasureTextScaled("Your cart is empty.", 20)/2, RY(0.45f), 20, colors.accent);
-                    DrawTextScaled("Browse products and click 'Add to Cart' to add items.", centerX - MeasureTextScaled("Browse products and click 'Add to Cart' to add items.", 16)/2, RY(0.50f), 16, colors.text);
+                    DrawTextScaled("Your cart is empty.", L.emptyX, L.emptyY, 20, colors.accent);
+                    DrawTextScaled("Browse products and click 'Add to Cart' to add items.", L.emptyHintX, L.emptyHintY, 16, colors.text);
                 } else {
-                    for (size_t i = 0; i < currentCart.size(); ++i) {
+                    BeginTextBatch(18);
+                    for (size_t i = 0; i < currentCart.size() && i < cartRows.size(); ++i) {
                         const auto &it = currentCart[i];
+                        CartRowLabels &row = cartRows[i];
+                        const CatalogEntry *prod = row.productIndex >= 0 ? &products[row.productIndex] : nullptr;
+                        bool hasPrice = prod && prod->hasPrice;
+                        bool hasSaleLocal = hasPrice && prod->hasSale;
                         // card background (narrower than full width to leave room for Remove button)
                         Rectangle card = { listX, y, cardW, rowH };
-                        DrawRectangleRec(card, Fade(colors.inputBg, 0.98f));
-                        DrawRectangleLinesEx(card, 2, colors.primary);
+                        gBackend->DrawRectangleRec(card, Fade(colors.inputBg, 0.98f));
+                        gBackend->DrawRectangleLinesEx(card, 2, colors.primary);
 
                         // Name (wrap naive)
                         DrawTextScaled(it.first.c_str(), (int)(card.x + 8), (int)(card.y + 8), 18, colors.text);
 
-                        // Price lookup
-                        double price = 0.0; bool hasPrice = false;
-                        double originalPrice = 0.0;
-                        bool hasSaleLocal = false;
-                        double salePercentLocal = 0.0;
-                        for (const auto &prod : products) {
-                            if (prod.name == it.first) {
-                                originalPrice = prod.price;
-                                hasPrice = prod.hasPrice;
-                                hasSaleLocal = prod.hasSale;
-                                salePercentLocal = prod.salePercent;
-                                break;
-                            }
-                        }
-                        if (hasPrice) {
-                            if (hasSaleLocal) price = originalPrice * (1.0 - salePercentLocal/100.0);
-                            else price = originalPrice;
-                        } else price = 0.0;
-                        std::ostringstream priceS; if (hasPrice) priceS << std::fixed << std::setprecision(2) << price; else priceS << "-";
-                        std::string priceStr = priceS.str();
-
                         // Qty controls (inside card)
                         Rectangle qtyRect = { card.x + colNameW, card.y + rowH*0.15f, colQtyW, rowH*0.7f };
                         Rectangle minusBtn = { qtyRect.x, qtyRect.y, qtyRect.width*0.36f, qtyRect.height };
                         Rectangle qtyLabel = { qtyRect.x + qtyRect.width*0.36f, qtyRect.y, qtyRect.width*0.28f, qtyRect.height };
                         Rectangle plusBtn = { qtyRect.x + qtyRect.width*0.64f, qtyRect.y, qtyRect.width*0.36f, qtyRect.height };
-                        if (DrawButton(minusBtn, "-", colors.buttonBg, colors, 18)) {
-                            if (currentCart[i].second > 1) currentCart[i].second -= 1; else { currentCart.erase(currentCart.begin() + i); }
-                            SaveCart(currentUser, currentCart);
-                        }
-                        DrawTextScaled(std::to_string(it.second).c_str(), (int)(qtyLabel.x + (qtyLabel.width - MeasureTextScaled(std::to_string(it.second).c_str(),18))/2), (int)(qtyLabel.y + 6), 18, colors.text);
-                        if (DrawButton(plusBtn, "+", colors.buttonBg, colors, 18)) { currentCart[i].second += 1; SaveCart(currentUser, currentCart); }
+                        DrawTextScaled(row.qty.text.c_str(), (int)(qtyLabel.x + (qtyLabel.width - row.qty.Width(18))/2), (int)(qtyLabel.y + 6), 18, colors.text);
 
                         // Price
                         float px = card.x + colNameW + colQtyW + 8;
-                        if (hasPrice && hasSaleLocal) {
+                        if (hasSaleLocal) {
                             // original struck-through
-                            std::ostringstream origs; origs.setf(std::ios::fixed); origs.precision(2); origs << "$" << originalPrice;
-                            std::string orig = origs.str();
-                            int origW = MeasureTextScaled(orig.c_str(), 16);
-                            DrawTextScaled(orig.c_str(), (int)px, (int)(card.y + 8), 16, Fade(colors.text, 0.6f));
+                            ProductLabels &labels = row.product;
+                            int origW = labels.price.Width(16);
+                            DrawTextScaled(labels.price.text.c_str(), (int)px, (int)(card.y + 8), 16, Fade(colors.text, 0.6f));
                             float lineY = card.y + 8 + ScaledFontSize(16) * 0.5f;
-                            DrawLineEx(Vector2{ px, lineY }, Vector2{ px + origW, lineY }, 2.0f, colors.text);
+                            gBackend->DrawRectangleRec(Rectangle{ px, lineY - 1.0f, (float)origW, 2.0f }, colors.text);
                             // sale price after original (smaller gap)
-                            double salePrice = originalPrice * (1.0 - salePercentLocal/100.0);
-                            std::ostringstream sps; sps.setf(std::ios::fixed); sps.precision(2); sps << "$" << salePrice;
-                            DrawTextScaled(sps.str().c_str(), (int)(px + origW + RW(0.005f)), (int)(card.y + 8), 16, colors.primary);
+                            DrawTextScaled(labels.sale.text.c_str(), (int)(px + origW + L.saleGap), (int)(card.y + 8), 16, colors.primary);
                         } else {
-                            DrawTextScaled(priceStr.c_str(), (int)px, (int)(card.y + 8), 18, colors.text);
+                            DrawTextScaled(row.price.text.c_str(), (int)px, (int)(card.y + 8), 18, colors.text);
                         }
 
                         // Subtotal
-                        double subtotal = hasPrice ? price * it.second : 0.0;
-                        if (hasPrice) {
-                            std::ostringstream ss; ss << std::fixed << std::setprecision(2) << subtotal;
-                            DrawTextScaled((std::string("$") + ss.str()).c_str(), (int)(card.x + colNameW + colQtyW + colPriceW + 8), (int)(card.y + 8), 18, colors.text);
-                            total += subtotal;
-                        } else {
-                            DrawTextScaled("-", (int)(card.x + colNameW + colQtyW + colPriceW + 8), (int)(card.y + 8), 18, colors.text);
+                        DrawTextScaled(row.subtotal.text.c_str(), (int)(card.x + colNameW + colQtyW + colPriceW + 8), (int)(card.y + 8), 18, colors.text);
+
+                        // Buttons last: they may change the cart (labels refresh next frame)
+                        bool changed = false;
+                        if (DrawButton(minusBtn, "-", colors.buttonBg, colors, 18)) {
+                            if (currentCart[i].second > 1) currentCart[i].second -= 1; else { currentCart.erase(currentCart.begin() + i); }
+                            changed = true;
                         }
+                        if (!changed && DrawButton(plusBtn, "+", colors.buttonBg, colors, 18)) { currentCart[i].second += 1; changed = true; }
 
                         // Remove small button on right (placed in the margin to avoid overlapping Subtotal)
-                        Rectangle remBtn = { card.x + card.width + RW(0.02f), card.y + rowH*0.18f, RW(0.12f), rowH*0.64f };
-                        if (DrawButton(remBtn, "Remove", (Color){220,80,80,255}, colors, 16)) { currentCart.erase(currentCart.begin() + i); SaveCart(currentUser, currentCart); }
+                        Rectangle remBtn = { card.x + card.width + L.remBtnGap, card.y + rowH*0.18f, L.remBtnW, rowH*0.64f };
+                        if (!changed && DrawButton(remBtn, "Remove", (Color){220,80,80,255}, colors, 16)) { currentCart.erase(currentCart.begin() + i); changed = true; }
+                        if (changed) { SaveCart(currentUser, currentCart); break; }
 
                         y += rowH + gap;
                     }
-
-                    // Compute totals string and defer drawing the totals box until after other UI so it isn't overlapped
-                    std::ostringstream tot; tot << "Total: $" << std::fixed << std::setprecision(2) << total;
-                    totStr = tot.str();
-                    // store totStr in a local variable; drawing will happen after main content so it stays on top
+                    EndTextBatch();
                 }
             }
 
+            // Totals string is cached with the row labels; drawn after main content so it stays on top
+            const char *totStr = (!currentUser.empty() && !currentCart.empty()) ? cartTotalLabel.text.c_str() : "";
+
             // Draw header last so it appears on top of cards
-            DrawTextScaled("My Cart", centerX - MeasureTextScaled("My Cart", 36)/2, RY(0.06f), 36, colors.primary);
+            DrawTextScaled("My Cart", L.titleX, L.titleY, 36, colors.primary);
 
             // Draw totals box after everything else so it remains on top and not overlapped
             {
-                Rectangle totBox = { (float)(centerX + RW(0.10f)), (float)RY(0.70f), (float)RW(0.34f), (float)RH(0.18f) };
-                DrawRectangleRec(totBox, Fade(colors.inputBg, 0.98f)); DrawRectangleLinesEx(totBox, 2, colors.primary);
-                DrawTextScaled(totStr.c_str(), (int)(totBox.x + 12), (int)(totBox.y + 12), 20, colors.primary);
+                const Rectangle &totBox = L.totBox;
+                gBackend->DrawRectangleRec(totBox, Fade(colors.inputBg, 0.98f)); gBackend->DrawRectangleLinesEx(totBox, 2, colors.primary);
+                DrawTextScaled(totStr, (int)(totBox.x + 12), (int)(totBox.y + 12), 20, colors.primary);
 
-                // Checkout and Clear buttons inside the totals box
-                Rectangle checkoutBtn = { totBox.x + 12, totBox.y + totBox.height - RH(0.06f) - 8, totBox.width - 24, RH(0.06f) };
-                if (DrawButton(checkoutBtn, "Checkout", colors.primary, colors, 20)) { currentCart.clear(); SaveCart(currentUser, currentCart); }
-                Rectangle clearBtn = { totBox.x + 12, totBox.y + totBox.height - RH(0.06f)*2 - 16, totBox.width - 24, RH(0.06f) };
-                if (DrawButton(clearBtn, "Clear Cart", (Color){200,70,70,255}, colors, 16)) { currentCart.clear(); SaveCart(currentUser, currentCart); }
+                if (DrawButton(L.checkoutBtn, "Checkout", colors.primary, colors, 20)) { currentCart.clear(); SaveCart(currentUser, currentCart); }
+                if (DrawButton(L.clearBtn, "Clear Cart", (Color){200,70,70,255}, colors, 16)) { currentCart.clear(); SaveCart(currentUser, currentCart); }
             }
         }
         else if (state == STATE_EDIT_PRODUCTS) {
             // Ensure products loaded
-            if (!productsLoaded) { productsLoaded = LoadProducts("data/products.txt"); }
-
-            // Back to Add Product screen
-            Rectangle backBtn = { (float)RX(0.025f), (float)RY(0.025f), (float)RW(0.10f), (float)RH(0.05f) };
-            if (DrawButton(backBtn, "< Back", colors.buttonBg, colors, 16)) state = STATE_MENU;
-
-            DrawTextScaled("Edit Products", centerX - MeasureTextScaled("Edit Products", 28)/2, RY(0.08f), 28, colors.primary);
-
-
-            Rectangle btnAdd = { (float)RX(0.4f), (float)RY(0.8f), (float)RW(0.16f), (float)RH(0.08f) };
-                if (DrawButton(btnAdd, "Add Product", colors.buttonBg, colors, 24)) state = STATE_ADD_PRODUCT;
-            // Simple scrollable list of products with Edit buttons
-            float startY = RY(0.16f);
-            float rowH = (float)RH(0.05f);
-            float y = startY;
-            for (size_t i = 0; i < products.size(); ++i) {
-                if (y > RY(0.18f) + RY(0.70f)) break; // don't render past area
-                const auto &p = products[i];
-                std::ostringstream ss; ss << p.name; if (p.hasPrice) { ss << " - $" << std::fixed << std::setprecision(2) << p.price; }
-                DrawTextScaled(ss.str().c_str(), RX(0.03f), (int)y, 18, colors.text);
-                    float actionBtnW = (float)RW(0.14f);
-                    float actionBtnH = (float)(rowH * 0.85f);
-                    float editBtnX = (float)(sw - RW(0.18f));
-                    Rectangle editBtn = { editBtnX, y - rowH*0.15f, actionBtnW, actionBtnH };
-                    Rectangle removeBtn = { editBtnX - (actionBtnW + RW(0.02f)), y - rowH*0.15f, actionBtnW, actionBtnH };
-                    if (DrawButton(editBtn, "Edit", colors.buttonBg, colors, 14)) {
-                        editProductIndex = (int)i;
+            if (!productsLoaded) { productsLoaded = LoadProducts(productsPath); }
+
+            EditProductsLayout &L = editProductsLayout;
+            if (L.generation != layoutGeneration) {
+                L.backBtn = { (float)RX(0.025f), (float)RY(0.025f), (float)RW(0.10f), (float)RH(0.05f) };
+                L.titleX = centerX - MeasureTextScaled("Edit Products", 28)/2;
+                L.titleY = (int)RY(0.08f);
+                L.messageX = (int)RX(0.45f);
+                L.messageY = (int)RY(0.19f);
+                L.btnAdd = { (float)RX(0.4f), (float)RY(0.8f), (float)RW(0.16f), (float)RH(0.08f) };
+                L.listTop = RY(0.23f); L.listBottom = RY(0.78f);
+                L.rowH = (float)RH(0.05f);
+                L.keyStep = RH(0.01f);
+                L.labelX = (int)RX(0.03f);
+                L.actionBtnW = (float)RW(0.14f);
+                L.actionBtnH = (float)(L.rowH * 0.85f);
+                L.editBtnX = (float)(sw - RW(0.18f));
+                L.removeBtnX = L.editBtnX - (L.actionBtnW + RW(0.02f));
+                L.noMatchX = centerX - MeasureTextScaled("No products match your search.", 18)/2;
+                L.noMatchY = (int)RY(0.40f);
+                L.minThumbH = RH(0.03f);
+                L.barX = (float)(sw - RW(0.02f));
+                L.barW = (float)RW(0.006f);
+                L.generation = layoutGeneration;
+            }
+            // Back to the menu
+            if (DrawButton(L.backBtn, "< Back", colors.buttonBg, colors, 16)) state = STATE_MENU;
+
+            DrawTextScaled("Edit Products", L.titleX, L.titleY, 28, colors.primary);
+
+            // Search by name; the matching rows are rebuilt only when the catalog or the search changed
+            std::string query = AdminSearchBox(editSearchInput, editSearchActive, true);
+            if (editListCatalogVersion != catalogVersion || editListQuery != query) {
+                ProfileScope prof(PROF_FILTER);
+                // nameOrder is already in name order, so filtering it in order needs no sort
+                editListIndices.clear();
+                if (!query.empty()) {
+                    const Bitmap &hits = NameMatches(query);
+                    for (int i : nameOrder) if (hits.Test((size_t)i)) editListIndices.push_back(i);
+                }
+                if (editListQuery != query) editListScroll = 0.0; // keep position across reloads after Edit/Remove
+                editListCatalogVersion = catalogVersion;
+                editListQuery = query;
+                ++editListVersion;
+            }
+            const std::vector<int> &editRows = editListQuery.empty() ? nameOrder : editListIndices;
+            AdminMatchCount(editRows.size(), products.size(), "products");
+            if (!editListMessage.empty()) DrawTextScaled(editListMessage.c_str(), L.messageX, L.messageY, 16, RED);
+
+            if (DrawButton(L.btnAdd, "Add Product", colors.buttonBg, colors, 24)) state = STATE_ADD_PRODUCT;
+
+            // Virtualized list: only the rows inside [listTop, listBottom) are formatted and drawn
+            const float listTop = L.listTop, listBottom = L.listBottom;
+            const float rowH = L.rowH;
+            float wheel = gBackend->GetMouseWheelMove(); editListScroll -= wheel * rowH;
+            if (gBackend->IsKeyDown(KEY_DOWN)) editListScroll -= L.keyStep;
+            if (gBackend->IsKeyDown(KEY_UP)) editListScroll += L.keyStep;
+            double contentH = (double)editRows.size() * rowH;
+            double minScroll = std::min(0.0, (listBottom - listTop) - contentH);
+            if (editListScroll < minScroll) editListScroll = minScroll;
+            if (editListScroll > 0) editListScroll = 0;
+
+            size_t firstVisible = (size_t)std::max(0L, (long)std::floor(-editListScroll / rowH));
+            size_t endVisible = std::min(editRows.size(), (size_t)std::max(0L, (long)std::ceil(((listBottom - listTop) - editListScroll) / rowH)));
+            if (editRowLabelsVersion != editListVersion || firstVisible != editRowLabelsFirst || editRowLabels.size() != endVisible - std::min(firstVisible, endVisible)) {
+                // Window moved: format just the visible rows
+                editRowLabels.clear();
+                Product full;
+                for (size_t i = firstVisible; i < endVisible; ++i) {
+                    const auto &p = products[editRows[i]];
+                    std::string name = catalogPages.ReadProduct(p.fileIndex, full) ? full.name : std::string("?");
+                    TextLabel label;
+                    label.text = p.hasPrice ? name + " - " + FormatMoney(p.price) : name;
+                    editRowLabels.push_back(label);
+                }
+                editRowLabelsFirst = firstVisible;
+                editRowLabelsVersion = editListVersion;
+            }
+
+            int removeIndex = -1;
+            if (editRows.empty() && !products.empty())
+                DrawTextScaled("No products match your search.", L.noMatchX, L.noMatchY, 18, ORANGE);
+            BeginTextBatch(18);
+            for (size_t i = firstVisible; i < endVisible; ++i) {
+                float y = (float)(listTop + (double)i * rowH + editListScroll);
+                if (y < listTop || y + rowH > listBottom + rowH * 0.5f) continue;
+                int productIndex = editRows[i];
+                DrawTextScaled(editRowLabels[i - firstVisible].text.c_str(), L.labelX, (int)y, 18, colors.text);
+                Rectangle editBtn = { L.editBtnX, y - rowH*0.15f, L.actionBtnW, L.actionBtnH };
+                Rectangle removeBtn = { L.removeBtnX, y - rowH*0.15f, L.actionBtnW, L.actionBtnH };
+                if (DrawButton(editBtn, "Edit", colors.buttonBg, colors, 14)) {
+                    // The form saves every column back, so it needs the product's full line
+                    if (catalogPages.ReadProduct(products[productIndex].fileIndex, editProductRecord)) {
+                        editProductIndex = productIndex;
                         editProductPopulateNeeded = true;
                         state = STATE_EDIT_PRODUCT;
+                        editListMessage.clear();
+                    } else editListMessage = "Cannot read this product from the catalog file";
+                }
+                if (DrawButton(removeBtn, "Remove", (Color){220,80,80,255}, colors, 14)) removeIndex = productIndex;
+            }
+            EndTextBatch();
+
+            // Scrollbar thumb showing where the window sits in the whole list
+            if (contentH > listBottom - listTop) {
+                float trackH = listBottom - listTop;
+                float thumbH = std::max(L.minThumbH, (float)(trackH * trackH / contentH));
+                float thumbY = listTop + (trackH - thumbH) * (float)(-editListScroll / (contentH - trackH));
+                gBackend->DrawRectangleRec(Rectangle{ L.barX, listTop, L.barW, trackH }, Fade(colors.inputBg, 0.8f));
+                gBackend->DrawRectangleRec(Rectangle{ L.barX, thumbY, L.barW, thumbH }, colors.accent);
+            }
+
+            if (removeIndex >= 0) {
+                // Remove product by name (safer when in-memory ordering differs from file order)
+                Product target;
+                bool targetRead = catalogPages.ReadProduct(products[removeIndex].fileIndex, target);
+                editListMessage = targetRead ? std::string() : std::string("Cannot read this product from the catalog file");
+                const std::string &targetName = target.name;
+                ProfileScope io(PROF_FILE_IO);
+                std::ifstream ifs(productsPath);
+                if (targetRead && ifs) {
+                    std::vector<std::string> lines; std::string line;
+                    while (std::getline(ifs, line)) lines.push_back(line);
+                    ifs.close();
+
+                    bool erased = false;
+                    for (auto it = lines.begin(); it != lines.end(); ++it) {
+                        std::string l = *it;
+                        if (l.empty()) continue;
+                        size_t psep = l.find(';');
+                        std::string lineName = (psep == std::string::npos) ? l : l.substr(0, psep);
+                        if (lineName == targetName) {
+                            lines.erase(it);
+                            erased = true;
+                            break;
+                        }
                     }
-                    if (DrawButton(removeBtn, "Remove", (Color){220,80,80,255}, colors, 14)) {
-                        // Remove product by name (safer when in-memory ordering differs from file order)
-                        const std::string targetName = p.name;
-                        std::ifstream ifs("data/products.txt");
-                        if (ifs) {
-                            std::vector<std::string> lines; std::string line;
-                            while (std::getline(ifs, line)) lines.push_back(line);
-                            ifs.close();
-
-                            bool erased = false;
-                            for (auto it = lines.begin(); it != lines.end(); ++it) {
-                                std::string l = *it;
-                                if (l.empty()) continue;
-                                size_t psep = l.find(';');
-                                std::string lineName = (psep == std::string::npos) ? l : l.substr(0, psep);
-                                if (lineName == targetName) {
-                                    lines.erase(it);
-                                    erased = true;
-                                    break;
-                                }
-                            }
 
-                            if (erased) {
-                                std::ofstream ofs("data/products.txt", std::ios::trunc);
-                                if (ofs) {
-                                    for (auto &l : lines) ofs << l << "\n";
-                                    ofs.close();
-                                    productsLoaded = false; needsResort = true;
-                                }
-                            }
+                    if (erased) {
+                        std::ofstream ofs(productsPath, std::ios::trunc);
+                        if (ofs) {
+                            for (auto &l : lines) ofs << l << "\n";
+                            ofs.close();
+                            productsLoaded = false; needsResort = true;
                         }
                     }
-                y += rowH;
+                }
             }
         }
         else if (state == STATE_EDIT_PRODUCT) {
             // Edit a single product by index
             if (editProductIndex < 0 || editProductIndex >= (int)products.size()) { state = STATE_EDIT_PRODUCTS; }
             else {
+                EditProductLayout &L = editProductLayout;
+                if (L.generation != layoutGeneration) {
+                    L.backBtn = { (float)RX(0.025f), (float)RY(0.025f), (float)RW(0.10f), (float)RH(0.05f) };
+                    L.titleX = centerX - MeasureTextScaled("Edit Product", 28)/2;
+                    L.titleY = (int)RY(0.05f);
+
+                    // Layout metrics (exactly matching Add Product)
+                    float topY = RY(0.10f);  // Same as Add Product
+                    L.labelX = RX(0.12f);
+                    float inputX = RX(0.30f);
+                    float fullW = RW(0.58f);
+                    float inputH = RH(0.06f);
+                    float gapV = RH(0.035f);
+
+                    L.nameRect = { inputX, topY, fullW, inputH };
+                    L.priceRect = { inputX, L.nameRect.y + inputH + gapV, fullW * 0.4f, inputH };
+                    // Category buttons (M/W/K/B) to the right of Price
+                    float catX = L.priceRect.x + L.priceRect.width + RW(0.02f);
+                    float catBtnW = RW(0.06f);
+                    float catBtnH = inputH * 0.9f;
+                    float catGap = RW(0.015f);
+                    for (size_t ci = 0; ci < 4; ++ci) L.catBtns[ci] = { catX + ci * (catBtnW + catGap), L.priceRect.y + (L.priceRect.height - catBtnH)/2.0f, catBtnW, catBtnH };
+                    // Sale % input below category buttons
+                    L.saleRect = { inputX, L.priceRect.y + L.priceRect.height + RH(0.03f), fullW * 0.2f, inputH };
+                    // Match Add Product vertical spacing
+                    float extraVerticalOffset = RH(0.08f);
+                    L.sizeAreaRect = { inputX, L.priceRect.y + inputH + gapV + extraVerticalOffset, fullW, inputH };
+                    float sbtnW = RW(0.09f), sbtnH = inputH * 0.9f, sGap = RW(0.02f);
+                    float totalS = sbtnW * 6.0f + sGap * (6.0f - 1.0f);
+                    float startSx = inputX + (fullW - totalS) / 2.0f;
+                    float sBtnsY = L.sizeAreaRect.y + (L.sizeAreaRect.height - sbtnH) / 2.0f;
+                    for (size_t si = 0; si < 6; ++si) L.sizeBtns[si] = { startSx + si * (sbtnW + sGap), sBtnsY, sbtnW, sbtnH };
+
+                    // Description area (matching Add Product layout)
+                    float descY = L.sizeAreaRect.y + inputH + gapV * 1.2f;
+                    float descH = (float)RH(0.18f);
+                    L.descRect = { inputX, descY, fullW, descH };
+
+                    // Action buttons: Update, Delete, Cancel (below description)
+                    float actionY = descY + L.descRect.height + gapV * 1.5f;
+                    float actionW = RW(0.22f), actionH = RH(0.08f), actionGap = RW(0.04f);
+                    float totalActionW = actionW * 3 + actionGap * 2;  // Space for 3 buttons
+                    float actionStartX = centerX - totalActionW / 2.0f;
+                    L.btnUpdate = { actionStartX, actionY, actionW, actionH };
+                    L.btnDelete = { actionStartX + actionW + actionGap, actionY, actionW, actionH };
+                    L.btnCancel = { actionStartX + (actionW + actionGap) * 2, actionY, actionW, actionH };
+                    L.generation = layoutGeneration;
+                }
                 // Back button
-                Rectangle backBtn = { (float)RX(0.025f), (float)RY(0.025f), (float)RW(0.10f), (float)RH(0.05f) };
-                if (DrawButton(backBtn, "< Back", colors.buttonBg, colors, 16)) state = STATE_EDIT_PRODUCTS;
+                if (DrawButton(L.backBtn, "< Back", colors.buttonBg, colors, 16)) state = STATE_EDIT_PRODUCTS;
 
-                DrawTextScaled("Edit Product", centerX - MeasureTextScaled("Edit Product", 28)/2, RY(0.05f), 28, colors.primary);
+                DrawTextScaled("Edit Product", L.titleX, L.titleY, 28, colors.primary);
 
                 // Form fields (populate from products[editProductIndex])
                 static std::string editName, editPrice, editSize, editSale; // Added editSale here
                 static int editCategory = 0;
                 static bool populated = false;
-                static std::string editDescription = "";
+                static TextField editDescription(4096, true);
                 static std::string origEditName = "";
                 static bool descFocus = false;
                 if (editProductPopulateNeeded || !populated) {
-                    const auto &p = products[editProductIndex];
+                    const Product &p = editProductRecord;
                     editName = p.name;
                     if (p.hasPrice) { std::ostringstream ss; ss.setf(std::ios::fixed); ss.precision(2); ss << p.price; editPrice = ss.str(); } else editPrice.clear();
                     editSize = p.size;
                     std::string s = p.sex; std::transform(s.begin(), s.end(), s.begin(), ::tolower);
                     if (s == "m") editCategory = 1; else if (s == "w") editCategory = 2; else if (s == "k") editCategory = 3; else if (s == "b") editCategory = 4; else editCategory = 0;
-                    editDescription = p.description;
+                    editDescription.Set(p.description);
                     // sale populate
                     if (p.hasSale) {
                         std::ostringstream ssp; ssp << (int)p.salePercent;
@@ -1834,85 +4751,56 @@ int main() {
                     editProductPopulateNeeded = false;
                 }
 
-                // Layout metrics (exactly matching Add Product)
-                float topY = RY(0.10f);  // Same as Add Product
-                float labelX = RX(0.12f);
-                float inputX = RX(0.30f);
-                float fullW = RW(0.58f);
-                float inputH = RH(0.06f);
-                float gapV = RH(0.035f);
-
-                Rectangle nameRect = { inputX, topY, fullW, inputH };
-                Rectangle priceRect = { inputX, nameRect.y + inputH + gapV, fullW * 0.4f, inputH };
-                // Category buttons layout
-                float catX = priceRect.x + priceRect.width + RW(0.02f);
-                float catBtnW = RW(0.06f);
-                float catBtnH = inputH * 0.9f;
-                float catGap = RW(0.015f);
-                // Match Add Product vertical spacing
-                float extraVerticalOffset = RH(0.08f);
-                Rectangle sizeAreaRect = { inputX, priceRect.y + inputH + gapV + extraVerticalOffset, fullW, inputH };
+                const float labelX = L.labelX;
+                const Rectangle &nameRect = L.nameRect;
+                const Rectangle &priceRect = L.priceRect;
+                const Rectangle &sizeAreaRect = L.sizeAreaRect;
 
                 DrawTextScaled("Name:", labelX, (int)nameRect.y + 6, 20, colors.text);
-                DrawRectangleRec(nameRect, colors.inputBg);
+                gBackend->DrawRectangleRec(nameRect, colors.inputBg);
                 DrawTextScaled(editName.c_str(), (int)nameRect.x + 8, (int)nameRect.y + 6, 18, colors.text);
 
                 DrawTextScaled("Price:", labelX, (int)priceRect.y + 6, 20, colors.text);
-                DrawRectangleRec(priceRect, colors.inputBg);
+                gBackend->DrawRectangleRec(priceRect, colors.inputBg);
                 DrawTextScaled(editPrice.c_str(), (int)priceRect.x + 8, (int)priceRect.y + 6, 18, colors.text);
 
                 // Category selection (M/W/K/B) placed to the right of Price (label removed)
                 static int selectedCategoryAdd = 0; // 0=none,1=M,2=W,3=K,4=B
-                const std::vector<std::string> catLabels = {"M","W","K","B"};
-                for (size_t ci = 0; ci < catLabels.size(); ++ci) {
-                    Rectangle cb = { catX + ci * (catBtnW + catGap), priceRect.y + (priceRect.height - catBtnH)/2.0f, catBtnW, catBtnH };
-                    if (DrawButton(cb, catLabels[ci].c_str(), colors.buttonBg, colors, 18)) editCategory = (int)ci + 1;
-                    if (editCategory == (int)ci + 1) DrawRectangleLinesEx(cb, 3, colors.accent);
+                static const char *const catLabels[] = {"M","W","K","B"};
+                for (size_t ci = 0; ci < 4; ++ci) {
+                    const Rectangle &cb = L.catBtns[ci];
+                    if (DrawButton(cb, catLabels[ci], colors.buttonBg, colors, 18)) editCategory = (int)ci + 1;
+                    if (editCategory == (int)ci + 1) gBackend->DrawRectangleLinesEx(cb, 3, colors.accent);
                 }
 
                 // Sale % input below category buttons
-                float saleY = priceRect.y + priceRect.height + RH(0.03f);
-                Rectangle saleRectEdit = { inputX, saleY, fullW * 0.2f, inputH };
+                const Rectangle &saleRectEdit = L.saleRect;
                 DrawTextScaled("Sale %:", labelX, (int)saleRectEdit.y, 20, colors.text);
-                DrawRectangleRec(saleRectEdit, colors.inputBg);
+                gBackend->DrawRectangleRec(saleRectEdit, colors.inputBg);
                 DrawTextScaled(editSale.c_str(), (int)saleRectEdit.x + 8, (int)saleRectEdit.y + 6, 18, colors.text);
                 static bool saleFocus = false;
-                if (saleFocus) DrawRectangleLinesEx(saleRectEdit, 2, colors.accent);
+                if (saleFocus) gBackend->DrawRectangleLinesEx(saleRectEdit, 2, colors.accent);
 
                 // Size selection (matching Add Product layout)
                 DrawTextScaled("Size:", labelX, (int)sizeAreaRect.y + 6, 24, colors.text);
                 static const std::vector<std::string> sizeOptions = {"XS","S","M","L","XL","XXL"};
-                float sbtnW = RW(0.09f), sbtnH = inputH * 0.9f, sGap = RW(0.02f);
-                float totalS = sbtnW * (float)sizeOptions.size() + sGap * ((float)sizeOptions.size() - 1.0f);
-                float startSx = inputX + (fullW - totalS) / 2.0f;
-                float sBtnsY = sizeAreaRect.y + (sizeAreaRect.height - sbtnH) / 2.0f;
-
                 for (size_t si = 0; si < sizeOptions.size(); ++si) {
-                    Rectangle sb = { startSx + si * (sbtnW + sGap), sBtnsY, sbtnW, sbtnH };
+                    const Rectangle &sb = L.sizeBtns[si];
                     if (DrawButton(sb, sizeOptions[si].c_str(), colors.buttonBg, colors, 18)) { editSize = sizeOptions[si]; }
-                    if (!editSize.empty() && editSize == sizeOptions[si]) DrawRectangleLinesEx(sb, 2, colors.accent);
+                    if (!editSize.empty() && editSize == sizeOptions[si]) gBackend->DrawRectangleLinesEx(sb, 2, colors.accent);
                 }
 
                 // Description area (matching Add Product layout)
-                float descY = sizeAreaRect.y + inputH + gapV * 1.2f;
-                float descH = (float)RH(0.18f);
-                Rectangle descRect = { inputX, descY, fullW, descH };
-                DrawTextScaled("Description:", labelX, (int)descY + 4, 20, colors.text);
-                DrawRectangleRec(descRect, colors.inputBg);
-                DrawTextScaled(editDescription.c_str(), (int)descRect.x + 8, (int)descRect.y + 8, 18, colors.text);
-                if (descFocus) DrawRectangleLinesEx(descRect, 2, colors.accent);
-
-                // Action buttons (matching Add Product layout)
-                float actionY = descY + descH + gapV * 1.2f;
-                float actionW = RW(0.22f), actionH = RH(0.08f), actionGap = RW(0.04f);
-                float totalActionW = actionW * 3 + actionGap * 2;  // Space for 3 buttons
-                float actionStartX = centerX - totalActionW / 2.0f;
+                const Rectangle &descRect = L.descRect;
+                DrawTextScaled("Description:", labelX, (int)descRect.y + 4, 20, colors.text);
+                gBackend->DrawRectangleRec(descRect, colors.inputBg);
+                if (descFocus) gBackend->DrawRectangleLinesEx(descRect, 2, colors.accent);
 
                 // Click-to-focus and keyboard input for Name/Price/Description fields
                 static int editFieldFocus = 0; // 0=name, 1=price, 2=none
 
-                Vector2 mousePos = GetMousePosition();
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+                Vector2 mousePos = gBackend->GetMousePosition();
+                if (gBackend->IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
                     if (CheckCollisionPointRec(mousePos, nameRect)) { editFieldFocus = 0; descFocus = false; saleFocus = false; }
                     else if (CheckCollisionPointRec(mousePos, priceRect)) { editFieldFocus = 1; descFocus = false; saleFocus = false; }
                     else if (CheckCollisionPointRec(mousePos, descRect)) { descFocus = true; editFieldFocus = 2; saleFocus = false; }
@@ -1920,47 +4808,40 @@ int main() {
                     else { editFieldFocus = 2; descFocus = false; saleFocus = false; }
                 }
                 // draw focus indicators
-                if (editFieldFocus == 0) DrawRectangleLinesEx(nameRect, 2, colors.accent);
-                if (editFieldFocus == 1) DrawRectangleLinesEx(priceRect, 2, colors.accent);
+                if (editFieldFocus == 0) gBackend->DrawRectangleLinesEx(nameRect, 2, colors.accent);
+                if (editFieldFocus == 1) gBackend->DrawRectangleLinesEx(priceRect, 2, colors.accent);
                 // (desc focus border will be drawn after the description area is rendered so it is visible)
 
                 // Text input handling routed by focus
-                int ch = GetCharPressed();
+                if (descFocus) {
+                    editDescription.HandleMouse(descRect, 16);
+                    editDescription.HandleKeys();
+                }
+                int ch = descFocus ? 0 : gBackend->GetCharPressed(); // the description drained it above
                 while (ch > 0) {
                     if (ch >= 32 && ch <= 125) {
-                        if (descFocus && editDescription.size() < 2048) editDescription.push_back((char)ch);
-                        else if (!descFocus && editFieldFocus == 0 && editName.size() < 200) editName.push_back((char)ch);
-                        else if (!descFocus && editFieldFocus == 1 && editPrice.size() < 64) editPrice.push_back((char)ch);
+                        if (editFieldFocus == 0 && editName.size() < 200) editName.push_back((char)ch);
+                        else if (editFieldFocus == 1 && editPrice.size() < 64) editPrice.push_back((char)ch);
                         else if (saleFocus && editSale.size() < 6) editSale.push_back((char)ch);
                     }
-                    ch = GetCharPressed();
+                    ch = gBackend->GetCharPressed();
                 }
-                if (IsKeyPressed(KEY_BACKSPACE)) {
-                    if (descFocus && !editDescription.empty()) editDescription.pop_back();
-                    else if (!descFocus && editFieldFocus == 0 && !editName.empty()) editName.pop_back();
-                    else if (!descFocus && editFieldFocus == 1 && !editPrice.empty()) editPrice.pop_back();
+                if (!descFocus && gBackend->IsKeyPressed(KEY_BACKSPACE)) {
+                    if (editFieldFocus == 0 && !editName.empty()) editName.pop_back();
+                    else if (editFieldFocus == 1 && !editPrice.empty()) editPrice.pop_back();
                     else if (saleFocus && !editSale.empty()) editSale.pop_back();
                 }
-                if (IsKeyPressed(KEY_TAB)) {
+                if (gBackend->IsKeyPressed(KEY_TAB)) {
                     if (!descFocus) {
                         if (editFieldFocus == 0) editFieldFocus = 1; else editFieldFocus = 0;
                     }
                 }
 
                 // Action buttons: Update, Delete, Cancel (moved below description)
-                actionY = descY + descRect.height + gapV * 1.5f;
-                actionW = RW(0.22f);
-                actionH = RH(0.08f);
-                actionGap = RW(0.04f);
-                totalActionW = actionW * 3 + actionGap * 2;
-                actionStartX = centerX - totalActionW / 2.0f;
-                Rectangle btnUpdate = { actionStartX, actionY, actionW, actionH };
-                Rectangle btnDelete = { actionStartX + actionW + actionGap, actionY, actionW, actionH };
-                Rectangle btnCancel = { actionStartX + (actionW + actionGap) * 2, actionY, actionW, actionH };
-
-                if (DrawButton(btnUpdate, "Update", colors.primary, colors, 20)) {
+                if (DrawButton(L.btnUpdate, "Update", colors.primary, colors, 20)) {
                     // write update by finding the original product line by name and replacing it
-                    std::ifstream ifs("data/products.txt");
+                    ProfileScope io(PROF_FILE_IO);
+                    std::ifstream ifs(productsPath);
                     if (!ifs) { /* fail */ }
                     else {
                         std::vector<std::string> lines; std::string line;
@@ -1980,7 +4861,7 @@ int main() {
 
                         // Build new product line using canonical format: name;price;size;fabric;sex;sale;description
                         std::ostringstream newline;
-                        newline << editName << ";" << editPrice << ";" << sizeToken << ";" << fabricToken << ";" << sexToken << ";" << (okSale ? std::to_string(salePercentVal) : "0") << ";" << editDescription;
+                        newline << editName << ";" << editPrice << ";" << sizeToken << ";" << fabricToken << ";" << sexToken << ";" << (okSale ? std::to_string(salePercentVal) : "0") << ";" << editDescription.Text();
                         std::string newLine = newline.str();
 
                         bool replaced = false;
@@ -1999,7 +4880,7 @@ int main() {
                         }
 
                         if (replaced) {
-                            std::ofstream ofs("data/products.txt", std::ios::trunc);
+                            std::ofstream ofs(productsPath, std::ios::trunc);
                             if (ofs) {
                                 for (auto &l : lines) ofs << l << "\n";
                                 ofs.close();
@@ -2008,39 +4889,34 @@ int main() {
                         }
                     }
                 }
-                if (DrawButton(btnDelete, "Delete", (Color){220,80,80,255}, colors, 20)) {
+                if (DrawButton(L.btnDelete, "Delete", (Color){220,80,80,255}, colors, 20)) {
                     // remove this product by index
-                    std::ifstream ifs("data/products.txt");
+                    ProfileScope io(PROF_FILE_IO);
+                    std::ifstream ifs(productsPath);
                     if (ifs) {
                         std::vector<std::string> lines; std::string line;
                         while (std::getline(ifs, line)) lines.push_back(line);
                         ifs.close();
                         if (editProductIndex >= 0 && editProductIndex < (int)lines.size()) {
                             lines.erase(lines.begin() + editProductIndex);
-                            std::ofstream ofs("data/products.txt", std::ios::trunc);
+                            std::ofstream ofs(productsPath, std::ios::trunc);
                             if (ofs) { for (auto &l : lines) ofs << l << "\n"; ofs.close(); }
                             productsLoaded = false; needsResort = true; populated = false; state = STATE_EDIT_PRODUCTS;
                         }
                     }
                 }
-                if (DrawButton(btnCancel, "Cancel", colors.buttonBg, colors, 20)) { state = STATE_EDIT_PRODUCTS; populated = false; }
+                if (DrawButton(L.btnCancel, "Cancel", colors.buttonBg, colors, 20)) { state = STATE_EDIT_PRODUCTS; populated = false; }
 
                 // Description textarea below action buttons (draw using descRect defined above)
                 DrawTextScaled("", labelX, (int)descRect.y - 18, 18, colors.text);
-                DrawRectangleRec(descRect, colors.inputBg);
-                // show text (simple multi-line naive wrap)
-                int lineY = (int)descRect.y + 6;
-                std::istringstream iss(editDescription);
-                std::string tokenLine;
-                while (std::getline(iss, tokenLine)) {
-                    DrawTextScaled(tokenLine.c_str(), (int)descRect.x + 6, lineY, 16, colors.text);
-                    lineY += 20;
-                }
+                gBackend->DrawRectangleRec(descRect, colors.inputBg);
+                // wrapped text, scrolled to keep the cursor line visible
+                editDescription.Draw(descRect, 16, colors.text, descFocus);
 
 
 
                 // Draw focus border for description (after the rect/content so it remains visible)
-                if (descFocus) DrawRectangleLinesEx(descRect, 2, colors.accent);
+                if (descFocus) gBackend->DrawRectangleLinesEx(descRect, 2, colors.accent);
 
                 // (input handled above routed by focus)
             }
@@ -2048,17 +4924,50 @@ int main() {
          else if (state == STATE_USER_MANAGEMENT) {
             // Admin user management: list users, edit password, remove users
             if (!isAdmin) { state = STATE_MENU; }
+            UsersLayout &L = usersLayout;
+            if (L.generation != layoutGeneration) {
+                L.backBtn = { (float)RX(0.025f), (float)RY(0.025f), (float)RW(0.10f), (float)RH(0.05f) };
+                L.titleX = centerX - MeasureTextScaled("Manage Accounts", 28)/2;
+                L.titleY = (int)RY(0.08f);
+                L.startY = RY(0.23f);
+                L.visibleH = RY(0.63f);
+                L.rowH = (float)RH(0.06f);
+                L.wheelStep = RH(0.05f);
+                L.keyStep = RH(0.01f);
+                L.noMatchX = centerX - MeasureTextScaled("No accounts match your search.", 18)/2;
+                L.noMatchY = (int)RY(0.40f);
+                L.labelX = (int)RX(0.03f);
+                L.actionBtnW = (float)RW(0.18f);
+                L.actionBtnH = (float)(L.rowH * 0.85f);
+                L.editBtnX = (float)(sw - RW(0.18f));
+                L.removeBtnX = L.editBtnX - (L.actionBtnW + RW(0.02f));
+
+                // Edit modal, centered inside the visible users area to avoid overlap on tall/fullscreen displays
+                float modalW = RW(0.72f);
+                float modalH = RH(0.28f);
+                L.modal.x = centerX - modalW/2.0f; L.modal.y = L.startY + (L.visibleH - modalH) / 2.0f; L.modal.width = modalW; L.modal.height = modalH;
+                const Rectangle &modal = L.modal;
+                L.passRect = { modal.x + 130, modal.y + 68, modal.width - 150, RH(0.06f) };
+                L.adminChk = { modal.x + 12, modal.y + 104, 20, 20 };
+                L.saveBtn = { modal.x + 12, modal.y + modal.height - RH(0.08f) - 12, modal.width * 0.45f - 18, RH(0.06f) };
+                L.cancelBtn = { modal.x + modal.width * 0.55f + 6, modal.y + modal.height - RH(0.08f) - 12, modal.width * 0.45f - 18, RH(0.06f) };
+                L.msgY = (int)(modal.y + modal.height - RH(0.08f) - 36);
+                L.generation = layoutGeneration;
+            }
             // Back button
-            Rectangle backBtn = { (float)RX(0.025f), (float)RY(0.025f), (float)RW(0.10f), (float)RH(0.05f) };
-            if (DrawButton(backBtn, "< Back", colors.buttonBg, colors, 16)) state = STATE_MENU;
+            if (DrawButton(L.backBtn, "< Back", colors.buttonBg, colors, 16)) state = STATE_MENU;
 
-            DrawTextScaled("Manage Accounts", centerX - MeasureTextScaled("Manage Accounts", 28)/2, RY(0.08f), 28, colors.primary);
+            DrawTextScaled("Manage Accounts", L.titleX, L.titleY, 28, colors.primary);
+
+            // Username prefix search, answered from the sorted name index
+            static TextField userSearchInput(63);
+            static bool userSearchActive = false;
 
             // Editable list with scroll/clipping to avoid overlap on large screens (F11)
-            float startY = RY(0.16f);
-            float visibleH = RY(0.70f);
-            float rowH = (float)RH(0.06f);
-            static float usersScroll = 0.0f;
+            const float startY = L.startY;
+            const float visibleH = L.visibleH;
+            const float rowH = L.rowH;
+            static double usersScroll = 0.0; // double, like productsScroll
             static int editUserIndex = -1;
             static bool editingUser = false;
             static std::string editUserNewPass = "";
@@ -2066,38 +4975,64 @@ int main() {
             static bool editUserJustOpened = false;
             static bool editUserCanChangePassword = false;
             static std::string editUserMsg = "";
+            static UserNameIndex userIndex;
+            static std::string userQuery;
+            // "name (Admin)" for the rows currently on screen; rebuilt when the window moves
+            static std::vector<TextLabel> userRowLabels;
+            static size_t userRowLabelsFirst = 0;
+            static unsigned userRowLabelsRevision = ~0u;
+
+            std::string query = AdminSearchBox(userSearchInput, userSearchActive, !editingUser);
+            if (userIndex.builtVersion != usersVersion) { ProfileScope prof(PROF_FILTER); userIndex.Build(users, usersVersion); }
+            if (query != userQuery) { userQuery = query; usersScroll = 0.0; userRowLabelsRevision = ~0u; }
+            std::pair<size_t, size_t> range = userIndex.Range(users, userQuery);
+            size_t matchCount = range.second - range.first;
+            AdminMatchCount(matchCount, users.size(), "accounts");
 
             // Scroll handling (mouse wheel + keyboard)
-            float wheel = GetMouseWheelMove(); usersScroll -= wheel * RH(0.05f);
-            if (IsKeyDown(KEY_DOWN)) usersScroll -= RH(0.01f);
-            if (IsKeyDown(KEY_UP)) usersScroll += RH(0.01f);
+            float wheel = gBackend->GetMouseWheelMove(); usersScroll -= wheel * L.wheelStep;
+            if (gBackend->IsKeyDown(KEY_DOWN)) usersScroll -= L.keyStep;
+            if (gBackend->IsKeyDown(KEY_UP)) usersScroll += L.keyStep;
 
             // clamp scroll to content height
-            float contentH = (float)users.size() * rowH;
-            float minScroll = std::min(0.0f, startY + visibleH - (startY + contentH)); // negative or zero
+            double contentH = (double)matchCount * rowH;
+            double minScroll = std::min(0.0, (double)visibleH - contentH); // negative or zero
             if (usersScroll < minScroll) usersScroll = minScroll;
             if (usersScroll > 0) usersScroll = 0;
 
-            float y = startY + usersScroll;
-            for (size_t i = 0; i < users.size(); ++i) {
-                const auto &u = users[i];
+            // Only the rows inside the visible area are walked
+            size_t firstVisible = (size_t)std::max(0L, (long)std::floor(-usersScroll / rowH));
+            size_t endVisible = std::min(matchCount, (size_t)std::max(0L, (long)std::ceil((visibleH - usersScroll) / rowH)));
+            firstVisible = std::min(firstVisible, endVisible);
+            if (userRowLabelsRevision != userIndex.revision || userRowLabelsFirst != range.first + firstVisible || userRowLabels.size() != endVisible - firstVisible) {
+                userRowLabels.clear();
+                for (size_t k = firstVisible; k < endVisible; ++k) {
+                    const User &u = users[userIndex.order[range.first + k]];
+                    TextLabel label;
+                    label.text = u.isAdmin ? u.name + " (Admin)" : u.name;
+                    userRowLabels.push_back(label);
+                }
+                userRowLabelsFirst = range.first + firstVisible;
+                userRowLabelsRevision = userIndex.revision;
+            }
 
-                // Clip: only render rows within visible area
-                if (y + rowH < startY) { y += rowH; continue; }
-                if (y > startY + visibleH) break;
+            int removeUserIndex = -1;
+            if (matchCount == 0 && !users.empty())
+                DrawTextScaled("No accounts match your search.", L.noMatchX, L.noMatchY, 18, ORANGE);
+            BeginTextBatch(18);
+            for (size_t k = firstVisible; k < endVisible; ++k) {
+                int i = userIndex.order[range.first + k];
+                const auto &u = users[i];
+                float y = (float)(startY + (double)k * rowH + usersScroll);
+                if (y + rowH < startY || y > startY + visibleH) continue;
 
-                std::string uname = u.name;
-                std::string displayName = uname + (u.isAdmin ? " (Admin)" : "");
-                DrawTextScaled(displayName.c_str(), RX(0.03f), (int)y, 18, colors.text);
+                DrawTextScaled(userRowLabels[k - firstVisible].text.c_str(), L.labelX, (int)y, 18, colors.text);
 
-                float actionBtnW = (float)RW(0.18f);
-                float actionBtnH = (float)(rowH * 0.85f);
-                float editBtnX = (float)(sw - RW(0.18f));
-                Rectangle editBtn = { editBtnX, y - rowH*0.15f, actionBtnW, actionBtnH };
-                Rectangle removeBtn = { editBtnX - (actionBtnW + RW(0.02f)), y - rowH*0.15f, actionBtnW, actionBtnH };
+                Rectangle editBtn = { L.editBtnX, y - rowH*0.15f, L.actionBtnW, L.actionBtnH };
+                Rectangle removeBtn = { L.removeBtnX, y - rowH*0.15f, L.actionBtnW, L.actionBtnH };
 
                 if (DrawButton(editBtn, "Edit", colors.buttonBg, colors, 14)) {
-                    editUserIndex = (int)i;
+                    editUserIndex = i;
                     editingUser = true;
                     // admin cannot view current password: leave new-pass empty and only update if admin types a new one
                     editUserNewPass = "";
@@ -2107,33 +5042,29 @@ int main() {
 
                 // Do not allow removing the main 'admin' account or the currently logged-in user
                 if (u.name != "admin" && u.name != currentUser) {
-                    if (DrawButton(removeBtn, "Remove", (Color){220,80,80,255}, colors, 14)) {
-                        users.erase(users.begin() + i);
-                        SaveAllUsers();
-                        // after erase, contentH changed; clamp scroll
-                        contentH = (float)users.size() * rowH;
-                        minScroll = std::min(0.0f, startY + visibleH - (startY + contentH));
-                        if (usersScroll < minScroll) usersScroll = minScroll;
-                        // do not increment y (next item occupies same visual slot)
-                        continue;
-                    }
+                    if (DrawButton(removeBtn, "Remove", (Color){220,80,80,255}, colors, 14)) removeUserIndex = i;
                 } else {
                     // disabled remove button (draw as plain rect)
-                    DrawRectangleRec(removeBtn, Fade(colors.inputBg, 0.98f));
-                    DrawRectangleLinesEx(removeBtn, 2, colors.primary);
+                    gBackend->DrawRectangleRec(removeBtn, Fade(colors.inputBg, 0.98f));
+                    gBackend->DrawRectangleLinesEx(removeBtn, 2, colors.primary);
                     DrawTextScaled("-", (int)(removeBtn.x + removeBtn.width/2 - MeasureTextScaled("-",14)/2), (int)(removeBtn.y + 6), 14, colors.text);
                 }
-
-                y += rowH;
+            }
+            EndTextBatch();
+
+            if (removeUserIndex >= 0) {
+                // Keep the index in step instead of re-sorting; users.txt is rewritten later by FlushUsers
+                userIndex.Erase(removeUserIndex);
+                users.erase(users.begin() + removeUserIndex);
+                if (editUserIndex == removeUserIndex) { editingUser = false; editUserIndex = -1; }
+                else if (editUserIndex > removeUserIndex) --editUserIndex;
+                MarkUsersDirty();
             }
 
             // Edit modal / inline area at bottom
             if (editingUser && editUserIndex >= 0 && editUserIndex < (int)users.size()) {
-                float modalW = RW(0.72f);
-                float modalH = RH(0.28f);
-                // Center the modal inside the visible users area to avoid overlap on tall/fullscreen displays
-                Rectangle modal; modal.x = centerX - modalW/2.0f; modal.y = startY + (visibleH - modalH) / 2.0f; modal.width = modalW; modal.height = modalH;
-                DrawRectangleRec(modal, Fade(colors.inputBg, 0.98f)); DrawRectangleLinesEx(modal, 2, colors.accent);
+                const Rectangle &modal = L.modal;
+                gBackend->DrawRectangleRec(modal, Fade(colors.inputBg, 0.98f)); gBackend->DrawRectangleLinesEx(modal, 2, colors.accent);
                 DrawTextScaled("Edit User", (int)modal.x + 12, (int)modal.y + 8, 20, colors.primary);
 
                 // Username (readonly)
@@ -2143,7 +5074,7 @@ int main() {
 
                 // Password input (masked — no reveal button: passwords must remain hidden)
                 DrawTextScaled("Password:", (int)modal.x + 12, (int)modal.y + 72, 18, colors.text);
-                Rectangle passRect = { modal.x + 130, modal.y + 68, modal.width - 150, RH(0.06f) };
+                const Rectangle &passRect = L.passRect;
               
 
                 // Always display masked password (asterisks). Admin cannot reveal stored passwords.
@@ -2166,8 +5097,8 @@ int main() {
                     editUserJustOpened = false;
                 }
                 // handle clicking into password field to focus
-                Vector2 mpos = GetMousePosition();
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+                Vector2 mpos = gBackend->GetMousePosition();
+                if (gBackend->IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
                     if (CheckCollisionPointRec(mpos, passRect)) {
                         // only allow focusing the password field when editing your own account
                         if (editUserCanChangePassword) userPassFocus = true;
@@ -2176,22 +5107,22 @@ int main() {
                 }
 
                 // Admin grant checkbox UI
-                Rectangle adminChk = { modal.x + 12, modal.y + 104, 20, 20 };
+                const Rectangle &adminChk = L.adminChk;
                 // draw checkbox background depending on state
-                DrawRectangleRec(adminChk, editUserGrantAdmin ? colors.primary : Fade(colors.inputBg, 0.98f));
-                DrawRectangleLinesEx(adminChk, 2, colors.primary);
+                gBackend->DrawRectangleRec(adminChk, editUserGrantAdmin ? colors.primary : Fade(colors.inputBg, 0.98f));
+                gBackend->DrawRectangleLinesEx(adminChk, 2, colors.primary);
                 DrawTextScaled("Grant admin rights", (int)(adminChk.x + adminChk.width + 8), (int)adminChk.y, 18, colors.text);
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+                if (gBackend->IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
                     if (CheckCollisionPointRec(mpos, adminChk) || CheckCollisionPointRec(mpos, (Rectangle){ adminChk.x + adminChk.width + 8, adminChk.y, 200, adminChk.height })) {
                         editUserGrantAdmin = !editUserGrantAdmin;
                     }
                 }
 
                 // Draw a visible focus border when the password input is active so it's clear the field has focus
-                if (userPassFocus) DrawRectangleLinesEx(passRect, 2, colors.accent);
+                if (userPassFocus) gBackend->DrawRectangleLinesEx(passRect, 2, colors.accent);
 
                 // Character input for password field. Only allow typing when editing your own account.
-                int c = GetCharPressed();
+                int c = gBackend->GetCharPressed();
                 if (c > 0 && !userPassFocus && editUserCanChangePassword) {
                     // begin editing password when any printable char is typed while modal is open
                     userPassFocus = true;
@@ -2200,9 +5131,9 @@ int main() {
                     if (editUserCanChangePassword) {
                         if (c >= 32 && c <= 125 && editUserNewPass.size() < 128) editUserNewPass.push_back((char)c);
                     }
-                    c = GetCharPressed();
+                    c = gBackend->GetCharPressed();
                 }
-                if (IsKeyPressed(KEY_BACKSPACE) && !editUserNewPass.empty() && editUserCanChangePassword) editUserNewPass.pop_back();
+                if (gBackend->IsKeyPressed(KEY_BACKSPACE) && !editUserNewPass.empty() && editUserCanChangePassword) editUserNewPass.pop_back();
 
                 // If admin is editing another user, show a small explanatory message
                 if (!editUserCanChangePassword) {
@@ -2210,9 +5141,7 @@ int main() {
                 }
 
                 // Save / Cancel
-                Rectangle saveBtn = { modal.x + 12, modal.y + modal.height - RH(0.08f) - 12, modal.width * 0.45f - 18, RH(0.06f) };
-                Rectangle cancelBtn = { modal.x + modal.width * 0.55f + 6, modal.y + modal.height - RH(0.08f) - 12, modal.width * 0.45f - 18, RH(0.06f) };
-                if (DrawButton(saveBtn, "Save", colors.primary, colors, 18)) {
+                if (DrawButton(L.saveBtn, "Save", colors.primary, colors, 18)) {
                     // commit change: only update password if a new one was entered AND the admin is editing their own account
                     if (!editUserNewPass.empty()) {
                         if (editUserCanChangePassword) {
@@ -2223,37 +5152,73 @@ int main() {
                     }
                     // update admin flag according to checkbox
                     users[editUserIndex].isAdmin = editUserGrantAdmin;
-                    SaveAllUsers();
+                    userRowLabelsRevision = ~0u; // "(Admin)" suffix may have changed
+                    MarkUsersDirty();
                     if (editUserMsg.empty()) {
                         editingUser = false; editUserIndex = -1; editUserNewPass.clear(); userPassFocus = false;
                     }
                 }
-                if (DrawButton(cancelBtn, "Cancel", colors.buttonBg, colors, 18)) {
+                if (DrawButton(L.cancelBtn, "Cancel", colors.buttonBg, colors, 18)) {
                     editingUser = false; editUserIndex = -1; editUserNewPass.clear(); userPassFocus = false; editUserMsg.clear();
                 }
-                if (!editUserMsg.empty()) DrawTextScaled(editUserMsg.c_str(), (int)(modal.x + 12), (int)(modal.y + modal.height - RH(0.08f) - 36), 14, ORANGE);
+                if (!editUserMsg.empty()) DrawTextScaled(editUserMsg.c_str(), (int)(modal.x + 12), L.msgY, 14, ORANGE);
             }
 
         }
-         else if (state == STATE_OPTIONS) {
+         else if (state == STATE_OPTIONS) DrawLayeredScreen([&]() {
+             OptionsLayout &L = optionsLayout;
+             if (L.generation != layoutGeneration) {
+                 L.backBtn = { (float)RX(0.025f), (float)RY(0.025f), (float)RW(0.10f), (float)RH(0.05f) };
+                 L.titleX = centerX - MeasureTextScaled("Options", 32)/2;
+                 L.titleY = (int)RY(0.12f);
+
+                 // Theme selection section (responsive layout)
+                 float sectionTop = RY(0.22f);
+                 L.themeLabelX = centerX - MeasureTextScaled("Theme:", 24)/2;
+                 L.themeLabelY = (int)sectionTop;
+                 float themeBtnW = RW(0.20f);
+                 float themeBtnH = RH(0.08f);
+                 float themeBtnGap = RW(0.04f);
+                 float themeY = sectionTop + RH(0.06f);
+                 L.themeDark = { centerX - themeBtnW - themeBtnGap/2.0f, themeY, themeBtnW, themeBtnH };
+                 L.themeLight = { centerX + themeBtnGap/2.0f, themeY, themeBtnW, themeBtnH };
+
+                 // Window mode selection: Windowed, Windowed-Fullscreen, Fullscreen (spaced horizontally)
+                 float winSectionY = themeY + themeBtnH + RH(0.06f);
+                 L.winLabelX = centerX - MeasureTextScaled("Window Mode:", 24)/2;
+                 L.winLabelY = (int)winSectionY;
+                 float winBtnsY = winSectionY + RH(0.06f);
+                 float winBtnW = RW(0.18f);
+                 float winBtnH = RH(0.08f);
+                 float totalWinW = winBtnW * 3 + themeBtnGap * 2;
+                 float startX = centerX - totalWinW/2.0f;
+                 L.winBtn = { startX, winBtnsY, winBtnW, winBtnH };
+                 L.winFsBtn = { startX + (winBtnW + themeBtnGap), winBtnsY, winBtnW, winBtnH };
+                 L.fsBtn = { startX + 2*(winBtnW + themeBtnGap), winBtnsY, winBtnW, winBtnH };
+
+                 // Frame pacing: target FPS and power saver (idle sleep) on one row under the window modes
+                 float paceY = winBtnsY + winBtnH + RH(0.03f);
+                 float fpsBtnW = RW(0.08f), paceBtnH = RH(0.06f), paceGap = RW(0.015f), saverBtnW = RW(0.20f);
+                 float paceStartX = centerX - (fpsBtnW * 3 + paceGap * 2 + RW(0.04f) + saverBtnW) / 2.0f;
+                 L.fpsLabelX = (int)(paceStartX - 10 - MeasureTextScaled("FPS:", 20));
+                 L.fpsLabelY = (int)(paceY + (paceBtnH - ScaledFontSize(20)) / 2);
+                 for (int f = 0; f < 3; ++f) L.fpsBtns[f] = { paceStartX + f * (fpsBtnW + paceGap), paceY, fpsBtnW, paceBtnH };
+                 L.saverBtn = { paceStartX + fpsBtnW * 3 + paceGap * 2 + RW(0.04f), paceY, saverBtnW, paceBtnH };
+
+                 L.resetBtn = { RW(0.5) - (winBtnW/2), winBtnsY + RY(0.2), winBtnW, winBtnH };
+                 L.generation = layoutGeneration;
+             }
               // Back button
-             Rectangle backBtn = { (float)RX(0.025f), (float)RY(0.025f), (float)RW(0.10f), (float)RH(0.05f) };
-             if (DrawButton(backBtn, "< Back", colors.buttonBg, colors, 16)) {
+             if (DrawButton(L.backBtn, "< Back", colors.buttonBg, colors, 16)) {
                   state = STATE_MENU;
               }
-             DrawTextScaled("Options", centerX - MeasureTextScaled("Options", 32)/2, RY(0.12f), 32, colors.primary);
+             DrawTextScaled("Options", L.titleX, L.titleY, 32, colors.primary);
              
 
-             // Theme selection section (responsive layout)
-             float sectionTop = RY(0.22f);
-             DrawTextScaled("Theme:", centerX - MeasureTextScaled("Theme:", 24)/2, sectionTop, 24, colors.text);
-
-             float themeBtnW = RW(0.20f);
-             float themeBtnH = RH(0.08f);
-             float themeBtnGap = RW(0.04f);
-             float themeY = sectionTop + RH(0.06f);
-             Rectangle themeButtonDark = { centerX - themeBtnW - themeBtnGap/2.0f, themeY, themeBtnW, themeBtnH };
-             Rectangle themeButtonLight = { centerX + themeBtnGap/2.0f, themeY, themeBtnW, themeBtnH };
+             // Theme selection section
+             DrawTextScaled("Theme:", L.themeLabelX, L.themeLabelY, 24, colors.text);
+             const Rectangle &themeButtonDark = L.themeDark;
+             const Rectangle &themeButtonLight = L.themeLight;
 
              Color darkBtnColor = (currentTheme == THEME_DARK) ? colors.primary : colors.buttonBg;
              Color lightBtnColor = (currentTheme == THEME_LIGHT) ? colors.primary : colors.buttonBg;
@@ -2267,17 +5232,11 @@ int main() {
                  colors = GetColorScheme(currentTheme);
              }
 
-            // Window mode selection: Windowed, Windowed-Fullscreen, Fullscreen (spaced horizontally)
-            float winSectionY = themeY + themeBtnH + RH(0.06f);
-            DrawTextScaled("Window Mode:", centerX - MeasureTextScaled("Window Mode:", 24)/2, winSectionY, 24, colors.text);
-            float winBtnsY = winSectionY + RH(0.06f);
-            float winBtnW = RW(0.18f);
-            float winBtnH = RH(0.08f);
-            float totalWinW = winBtnW * 3 + themeBtnGap * 2;
-            float startX = centerX - totalWinW/2.0f;
-            Rectangle winBtn = { startX, winBtnsY, winBtnW, winBtnH };
-            Rectangle winFsBtn = { startX + (winBtnW + themeBtnGap), winBtnsY, winBtnW, winBtnH };
-            Rectangle fsBtn = { startX + 2*(winBtnW + themeBtnGap), winBtnsY, winBtnW, winBtnH };
+            // Window mode selection
+            DrawTextScaled("Window Mode:", L.winLabelX, L.winLabelY, 24, colors.text);
+            const Rectangle &winBtn = L.winBtn;
+            const Rectangle &winFsBtn = L.winFsBtn;
+            const Rectangle &fsBtn = L.fsBtn;
 
              Color winColor = (currentWindowMode == WM_WINDOWED) ? colors.primary : colors.buttonBg;
              Color winFsColor = (currentWindowMode == WM_WINDOWED_FULLSCREEN) ? colors.primary : colors.buttonBg;
@@ -2293,208 +5252,113 @@ int main() {
                  ApplyWindowMode(WM_FULLSCREEN);
              }
 
-            Rectangle resetpwBtn = { RW(0.5) - (winBtnW/2), winBtnsY + RY(0.2), winBtnW, winBtnH };
-            if (DrawButton(resetpwBtn, "Reset Password", colors.buttonBg, colors, 18)) {
-                {
-                    // Show a blocking modal popup to reset a user's password.
-                    // We end the current frame, run a small modal loop, then continue the main loop.
-                    EndDrawing();
-
-                    std::string resetUser;
-                    bool modalOpen = true;
-                    bool inputFocus = false; // Changed to false initially
-
-                    while (!WindowShouldClose() && modalOpen) {
-                        BeginDrawing();
-                        ClearBackground(colors.background);
-
-                        // Dim background
-                        DrawRectangle(0, 0, sw, sh, Fade(BLACK, 0.45f));
-
-                        // Modal box
-                        Rectangle modal;
-                        modal.width = RW(0.5f);
-                        modal.height = RH(0.40f);
-                        modal.x = centerX - modal.width / 2.0f;
-                        modal.y = RY(0.22f);
-                        DrawRectangleRec(modal, Fade(colors.inputBg, 0.98f));
-                        DrawRectangleLinesEx(modal, 2, colors.accent);
-
-                        DrawTextScaled("Reset Password", (int)modal.x + 20, (int)modal.y + 16, 20, colors.primary);
-                        // Reset password for the currently logged in user.
-                        // Replace the old single-username input with three fields:
-                        // Old password, New password, Confirm new password.
-                        // Input fields layout
-                        Rectangle oldRect = { modal.x + 20, modal.y + 78, modal.width - 40, RH(0.06f) };
-                        Rectangle newRect = { modal.x + 20, modal.y + 78 + RH(0.08f), modal.width - 40, RH(0.06f) };
-                        Rectangle confRect = { modal.x + 20, modal.y + 78 + RH(0.16f), modal.width - 40, RH(0.06f) };
-
-                        // Persistent modal-local state
-                        static int focusIndex = 0; // 0 = old, 1 = new, 2 = confirm
-                        static std::string newPass;
-                        static std::string confirmPass;
-                        static std::string modalError;
-                        Vector2 mpos = GetMousePosition();
-
-                        // Draw boxes and labels
-                        DrawTextScaled("Old Password:", (int)oldRect.x, (int)oldRect.y - 20, 14, colors.text);
-                        DrawRectangleRec(oldRect, colors.inputBg);
-                        std::string oldMasked = std::string(resetUser.size(), '*');
-                        DrawTextScaled(oldMasked.c_str(), (int)oldRect.x + 6, (int)oldRect.y + 6, 18, colors.text);
-                        if (focusIndex == 0) DrawRectangleLinesEx(oldRect, 2, colors.accent);
-
-                        // Accept keyboard input for the Old Password field when it has focus.
-                        // Keep resetUser length limited to match other handling (63 chars).
-                        if (focusIndex == 0) {
-                            int c = GetCharPressed();
-                            while (c > 0) {
-                                if (c >= 32 && c <= 125 && resetUser.size() < 63) resetUser.push_back((char)c);
-                                c = GetCharPressed();
-                            }
-                            if (IsKeyPressed(KEY_BACKSPACE) && !resetUser.empty()) resetUser.pop_back();
-                        }
-                        // keep inputFocus in sync so other handlers (New/Confirm) behave correctly
-                        inputFocus = (focusIndex == 0);
-
-                        DrawTextScaled("New Password:", (int)newRect.x, (int)newRect.y - 20, 14, colors.text);
-                        DrawRectangleRec(newRect, colors.inputBg);
-                        std::string newMasked = std::string(newPass.size(), '*');
-                        DrawTextScaled(newMasked.c_str(), (int)newRect.x + 6, (int)newRect.y + 6, 18, colors.text);
-                        if (focusIndex == 1) DrawRectangleLinesEx(newRect, 2, colors.accent);
-
-                        DrawTextScaled("Confirm New Password:", (int)confRect.x, (int)confRect.y - 20, 14, colors.text);
-                        DrawRectangleRec(confRect, colors.inputBg);
-                        std::string confMasked = std::string(confirmPass.size(), '*');
-                        DrawTextScaled(confMasked.c_str(), (int)confRect.x + 6, (int)confRect.y + 6, 18, colors.text);
-                        if (focusIndex == 2) DrawRectangleLinesEx(confRect, 2, colors.accent);
-
-                        // Mouse click to focus fields
-                        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                            if (CheckCollisionPointRec(mpos, oldRect)) { 
-                                focusIndex = 0;
-                                inputFocus = true; // Set inputFocus when clicking old password field
-                            }
-                            else if (CheckCollisionPointRec(mpos, newRect)) { 
-                                focusIndex = 1;
-                                inputFocus = false;
-                            }
-                            else if (CheckCollisionPointRec(mpos, confRect)) { 
-                                focusIndex = 2;
-                                inputFocus = false;
-                            }
-                        }
-
-                        // Handle character input for New and Confirm fields here
-                        if (!inputFocus) { // Only handle these when not focused on old password
-                            int ch2 = GetCharPressed();
-                            while (ch2 > 0) {
-                                if (ch2 >= 32 && ch2 <= 125) {
-                                    if (focusIndex == 1 && newPass.size() < 128) newPass.push_back((char)ch2);
-                                    else if (focusIndex == 2 && confirmPass.size() < 128) confirmPass.push_back((char)ch2);
-                                }
-                                ch2 = GetCharPressed();
-                            }
-                            if (IsKeyPressed(KEY_BACKSPACE)) {
-                                if (focusIndex == 1 && !newPass.empty()) newPass.pop_back();
-                                else if (focusIndex == 2 && !confirmPass.empty()) confirmPass.pop_back();
-                            }
-                        }
-
-                        // Draw (and handle) buttons using the same positions the original code will use later
-                        Rectangle okBtnLocal = { modal.x + 20, modal.y + modal.height - RH(0.08f) - 12, modal.width * 0.45f - 10, RH(0.06f) };
-                        Rectangle cancelBtnLocal = { modal.x + modal.width * 0.55f + 6, modal.y + modal.height - RH(0.08f) - 12, modal.width * 0.45f - 10, RH(0.06f) };
-                        // We draw nothing here (the original code draws the buttons later), but we intercept clicks
-                        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                            if (CheckCollisionPointRec(mpos, okBtnLocal)) {
-                                // Validate and apply password change for the logged-in user
-                                modalError.clear();
-                                if (currentUser.empty()) {
-                                    modalError = "No user logged in.";
-                                } else {
-                                    // Find the user record
-                                    int ui = -1;
-                                    for (size_t i = 0; i < users.size(); ++i) if (users[i].name == currentUser) { ui = (int)i; break; }
-                                    if (ui < 0) modalError = "User record not found.";
-                                    else {
-                                        // resetUser currently holds the typed old password (from the existing keyboard handler)
-                                        if (resetUser != users[ui].pass) modalError = "Old password incorrect.";
-                                        else if (newPass.empty()) modalError = "New password required.";
-                                        else if (newPass != confirmPass) modalError = "New passwords do not match.";
-                                        else if (newPass.size() < 8) modalError = "New password must be at least 8 characters.";
-                                        else {
-                                            // Commit change
-                                            users[ui].pass = newPass;
-                                            SaveAllUsers();
-                                            // Prevent the original confirm-handler (which resets by username) from doing anything:
-                                            resetUser = "__handled__";
-                                            modalOpen = false;
-                                        }
-                                    }
-                                    // Clear password fields on failure but don't close modal
-                                    if (!modalError.empty()) {
-                                        newPass.clear();
-                                        confirmPass.clear();
-                                        resetUser.clear();
-                                        focusIndex = 0;
-                                    } else {
-                                        modalOpen = false; // Only close on success
-                                    }
-                                }
-                            } else if (CheckCollisionPointRec(mpos, cancelBtnLocal)) {
-                                // Cancel: just close modal and neutralize original handler
-                                resetUser = "__handled__";
-                                modalOpen = false;
-                            }
-                        }
-
-                        // Show any validation error
-                        if (!modalError.empty()) {
-                            DrawTextScaled(modalError.c_str(), (int)modal.x + 20, (int)(confRect.y + confRect.height + RH(0.02f)), 14, ORANGE);
-                        }
-
-                        // Keyboard input for the username field
-                        if (inputFocus) {
-                            int c = GetCharPressed();
-                            while (c > 0) {
-                                if (c >= 32 && c <= 125 && resetUser.size() < 63) resetUser.push_back((char)c);
-                                c = GetCharPressed();
-                            }
-                            if (IsKeyPressed(KEY_BACKSPACE) && !resetUser.empty()) resetUser.pop_back();
-                        }
-
-                        // Buttons
-                        Rectangle okBtn = { modal.x + 20, modal.y + modal.height - RH(0.075f), modal.width * 0.45f - 10, RH(0.06f) };
-                        Rectangle cancelBtn = { modal.x + modal.width * 0.55f, modal.y + modal.height - RH(0.075f), modal.width * 0.45f - 10, RH(0.06f) };
+            // Frame pacing: target FPS and power saver
+            DrawTextScaled("FPS:", L.fpsLabelX, L.fpsLabelY, 20, colors.text);
+            const int fpsChoices[3] = { 30, 60, 120 };
+            for (int f = 0; f < 3; ++f) {
+                const Rectangle &fpsBtn = L.fpsBtns[f];
+                Color fpsColor = (targetFps == fpsChoices[f]) ? colors.primary : colors.buttonBg;
+                if (DrawButton(fpsBtn, std::to_string(fpsChoices[f]).c_str(), fpsColor, colors, 18)) {
+                    targetFps = fpsChoices[f];
+                    gBackend->SetTargetFPS(targetFps);
+                }
+            }
+            if (DrawButton(L.saverBtn, powerSaver ? "Power saver: On" : "Power saver: Off", powerSaver ? colors.primary : colors.buttonBg, colors, 18)) {
+                powerSaver = !powerSaver;
+            }
 
-                        if (DrawButton(okBtn, "Confirm", colors.primary, colors, 18)) {
-                            // Basic reset action: set password to "1234" for the matched user (admins preserved).
-                            bool found = false;
-                            for (auto &u : users) {
-                                if (u.name == resetUser) {
-                                    u.pass = "1234";
-                                    found = true;
-                                    break;
-                                }
-                            }
-                            if (found) SaveAllUsers();
-                            modalOpen = false;
-                        }
-                        if (DrawButton(cancelBtn, "Cancel", colors.buttonBg, colors, 18)) {
-                            modalOpen = false;
-                        }
+            if (DrawButton(L.resetBtn, "Reset Password", colors.buttonBg, colors, 18)) {
+                resetModal = ResetPasswordModal{};
+                resetModal.open = true;
+            }
+          });
+ 
+        stateScope.End();
+
+        // Reset Password overlay for the logged-in user: old, new and confirm fields
+        if (resetModal.open && state != STATE_OPTIONS) resetModal.open = false;
+        if (resetModal.open) {
+            ResetPasswordModal &M = resetModal;
+            // Dim background
+            gBackend->DrawRectangle(0, 0, sw, sh, Fade(BLACK, 0.45f));
+
+            ResetModalLayout &L = resetModalLayout;
+            if (L.generation != layoutGeneration) {
+                L.modal = { centerX - RW(0.5f) / 2.0f, RY(0.22f), RW(0.5f), RH(0.40f) };
+                const Rectangle &modal = L.modal;
+                L.fieldRects[0] = { modal.x + 20, modal.y + 78, modal.width - 40, RH(0.06f) };
+                L.fieldRects[1] = { modal.x + 20, modal.y + 78 + RH(0.08f), modal.width - 40, RH(0.06f) };
+                L.fieldRects[2] = { modal.x + 20, modal.y + 78 + RH(0.16f), modal.width - 40, RH(0.06f) };
+                L.errorY = (int)(L.fieldRects[2].y + L.fieldRects[2].height + RH(0.02f));
+                L.okBtn = { modal.x + 20, modal.y + modal.height - RH(0.075f), modal.width * 0.45f - 10, RH(0.06f) };
+                L.cancelBtn = { modal.x + modal.width * 0.55f, modal.y + modal.height - RH(0.075f), modal.width * 0.45f - 10, RH(0.06f) };
+                L.generation = layoutGeneration;
+            }
+            const Rectangle &modal = L.modal;
+            gBackend->DrawRectangleRec(modal, Fade(colors.inputBg, 0.98f));
+            gBackend->DrawRectangleLinesEx(modal, 2, colors.accent);
+            DrawTextScaled("Reset Password", (int)modal.x + 20, (int)modal.y + 16, 20, colors.primary);
+
+            const Rectangle *fieldRects = L.fieldRects;
+            const char *fieldLabels[3] = { "Old Password:", "New Password:", "Confirm New Password:" };
+            std::string *fields[3] = { &M.oldPass, &M.newPass, &M.confirmPass };
+            const size_t fieldMax[3] = { 63, 128, 128 };
+
+            // Mouse click to focus fields, typing goes to the focused one
+            Vector2 mpos = gBackend->GetMousePosition();
+            if (gBackend->IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+                for (int f = 0; f < 3; ++f) if (CheckCollisionPointRec(mpos, fieldRects[f])) M.focusIndex = f;
+            }
+            if (gBackend->IsKeyPressed(KEY_TAB)) M.focusIndex = (M.focusIndex + 1) % 3;
+            std::string &focused = *fields[M.focusIndex];
+            int c = gBackend->GetCharPressed();
+            while (c > 0) {
+                if (c >= 32 && c <= 125 && focused.size() < fieldMax[M.focusIndex]) focused.push_back((char)c);
+                c = gBackend->GetCharPressed();
+            }
+            if (gBackend->IsKeyPressed(KEY_BACKSPACE) && !focused.empty()) focused.pop_back();
+
+            for (int f = 0; f < 3; ++f) {
+                const Rectangle &r = fieldRects[f];
+                DrawTextScaled(fieldLabels[f], (int)r.x, (int)r.y - 20, 14, colors.text);
+                gBackend->DrawRectangleRec(r, colors.inputBg);
+                std::string masked(fields[f]->size(), '*');
+                DrawTextScaled(masked.c_str(), (int)r.x + 6, (int)r.y + 6, 18, colors.text);
+                if (M.focusIndex == f) gBackend->DrawRectangleLinesEx(r, 2, colors.accent);
+            }
 
-                        EndDrawing();
-                    }
+            // Show any validation error
+            if (!M.error.empty()) {
+                DrawTextScaled(M.error.c_str(), (int)modal.x + 20, L.errorY, 14, ORANGE);
+            }
 
-                    // After closing modal, continue main loop (skip the rest of this frame)
-                    continue;
+            if (DrawButton(L.okBtn, "Confirm", colors.primary, colors, 18) || gBackend->IsKeyPressed(KEY_ENTER)) {
+                // Validate and apply password change for the logged-in user
+                M.error.clear();
+                int ui = -1;
+                for (size_t i = 0; i < users.size(); ++i) if (users[i].name == currentUser) { ui = (int)i; break; }
+                if (currentUser.empty()) M.error = "No user logged in.";
+                else if (ui < 0) M.error = "User record not found.";
+                else if (M.oldPass != users[ui].pass) M.error = "Old password incorrect.";
+                else if (M.newPass.empty()) M.error = "New password required.";
+                else if (M.newPass != M.confirmPass) M.error = "New passwords do not match.";
+                else if (M.newPass.size() < 8) M.error = "New password must be at least 8 characters.";
+                if (M.error.empty()) {
+                    users[ui].pass = M.newPass;
+                    SaveAllUsers();
+                    M = ResetPasswordModal{};
+                } else {
+                    // Clear password fields on failure but keep the modal open
+                    M.oldPass.clear(); M.newPass.clear(); M.confirmPass.clear();
+                    M.focusIndex = 0;
                 }
             }
-          }
- 
+            if (DrawButton(L.cancelBtn, "Cancel", colors.buttonBg, colors, 18)) M = ResetPasswordModal{};
+        }
+
         // Update and draw transient popup notifications (non-blocking)
         if (cartPopupTimer > 0.0f) {
-            cartPopupTimer -= GetFrameTime();
+            cartPopupTimer -= gBackend->GetFrameTime();
             float alpha = std::max(0.0f, std::min(1.0f, cartPopupTimer / cartPopupDur));
             if (!cartPopupMsg.empty() && alpha > 0.0f) {
                 // Draw a rounded rectangle-like box centered near bottom
@@ -2505,22 +5369,72 @@ int main() {
                 float boxW = textW + padX * 2.0f;
                 float boxH = textH + padY * 2.0f;
                 float bx = (float)(centerX - boxW/2.0f);
-                float by = (float)(GetScreenHeight() - RH(0.10f));
+                float by = (float)(gBackend->GetScreenHeight() - RH(0.10f));
                 Color bg = colors.primary; bg.a = (unsigned char)(255.0f * alpha * 0.95f);
-                DrawRectangleRec({bx, by, boxW, boxH}, bg);
-                DrawRectangleLinesEx({bx, by, boxW, boxH}, 2, Fade(colors.accent, alpha));
+                gBackend->DrawRectangleRec({bx, by, boxW, boxH}, bg);
+                gBackend->DrawRectangleLinesEx({bx, by, boxW, boxH}, 2, Fade(colors.accent, alpha));
                 DrawTextScaled(cartPopupMsg.c_str(), (int)(bx + padX), (int)(by + padY/2.0f), 18, Fade(colors.text, alpha));
             }
         }
 
-        EndDrawing();
+        // Power saver: once a couple of frames have passed with no input and nothing animating,
+        // let EndDrawing block until the next event instead of redrawing an unchanged screen.
+        // The extra frame after input lets a click's state change reach the screen first.
+        // Held keys count too: GetKeyPressed reports a key once, but scrolling and text editing keep
+        // acting on every frame while the key is down (IsKeyDown / key repeat)
+        static const int kHeldKeys[] = { KEY_UP, KEY_DOWN, KEY_LEFT, KEY_RIGHT, KEY_PAGE_UP, KEY_PAGE_DOWN,
+                                         KEY_HOME, KEY_END, KEY_BACKSPACE, KEY_DELETE };
+        bool keyHeld = false;
+        for (int key : kHeldKeys) if (gBackend->IsKeyDown(key)) { keyHeld = true; break; }
+        Vector2 mouseDelta = gBackend->GetMouseDelta();
+        bool inputSeen = gBackend->GetKeyPressed() != 0 || keyHeld || mouseDelta.x != 0.0f || mouseDelta.y != 0.0f ||
+                         gBackend->GetMouseWheelMove() != 0.0f || gBackend->IsWindowResized() ||
+                         gBackend->IsMouseButtonDown(MOUSE_LEFT_BUTTON) || gBackend->IsMouseButtonReleased(MOUSE_LEFT_BUTTON) ||
+                         gBackend->IsMouseButtonDown(MOUSE_RIGHT_BUTTON) || gBackend->IsMouseButtonReleased(MOUSE_RIGHT_BUTTON);
+        // A pending users.txt write waits on a timer, so keep frames coming until it lands
+        bool animating = cartPopupTimer > 0.0f || gProfiler.enabled || gThumbnails.Busy() || usersDirty;
+        idleFrames = (inputSeen || animating) ? 0 : idleFrames + 1;
+        bool wantWaiting = powerSaver && !benchText && !benchDraw && idleFrames >= 2;
+        if (wantWaiting != eventWaiting) {
+            if (wantWaiting) gBackend->EnableEventWaiting(); else gBackend->DisableEventWaiting();
+            eventWaiting = wantWaiting;
+        }
+
+        if (gProfiler.enabled) DrawProfilerOverlay(state, colors);
+
+        gDrawStats.EndFrame();
+        ProfileScope presentScope(PROF_PRESENT);
+        gBackend->EndDrawing();
     }
     
-    // at exit, unload the font
-    UnloadFont(gFont);
-    UnloadTexture(logo);
-    UnloadTexture(homeIcon);
-    CloseWindow();
+    if (headless && !script.frameMs.empty()) {
+        std::vector<double> sorted = script.frameMs;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (double ms : sorted) sum += ms;
+        size_t n = sorted.size();
+        printf("[headless] %s: %zu frames, CPU ms/frame mean %.3f  p50 %.3f  p99 %.3f  max %.3f\n", headlessScript.c_str(), n,
+               sum / n, sorted[n / 2], sorted[std::min(n - 1, (size_t)(n * 0.99))], sorted[n - 1]);
+        double frames = (double)n + 1;
+        printf("[headless] commands/frame: %.1f rects, %.1f outlines, %.1f textures, %.1f texts (%.1f glyphs), %.1f texture binds\n",
+               nullBackend.totalCommands[NullBackend::CMD_RECT] / frames, nullBackend.totalCommands[NullBackend::CMD_RECT_LINES] / frames,
+               nullBackend.totalCommands[NullBackend::CMD_TEXTURE] / frames, nullBackend.totalCommands[NullBackend::CMD_TEXT] / frames,
+               nullBackend.totalGlyphs / frames, nullBackend.totalBinds / frames);
+        printf("[headless] catalog: %zu products, %zu row pages read (%zu resident, %zu rows each)\n",
+               products.size(), catalogPages.pageLoads, catalogPages.pages.size(), CatalogPages::kPageRows);
+        if (gThumbnails.enabled)
+            printf("[headless] thumbnails: %zu uploaded, %zu evicted, %zu known, %zu atlas pages (%.1f MB)\n", gThumbnails.uploads, gThumbnails.evictions,
+                   gThumbnails.entries.size(), gThumbnails.pages.size(), gThumbnails.memoryUsed / (1024.0 * 1024.0));
+    }
+
+    FlushUsers();
+    // at exit, unload the fonts
+    gFonts.Unload();
+    gThumbnails.Shutdown();
+    icons.Unload();
+    if (staticLayer.id != 0) gBackend->UnloadRenderTexture(staticLayer);
+    gDrawStats.Shutdown();
+    gBackend->CloseWindow();
     std::cout << "Exiting application." << std::endl;
     return 0;
     